@@ -38,6 +38,7 @@
 #include "nodeFactory.h"
 #include "pipe.h"
 #include "pixelData.h"
+#include "roiFinder.h"
 #include "server.h"
 #include "systemWindow.h"
 #include "view.h"
@@ -54,6 +55,7 @@
 #include <co/objectICommand.h>
 #include <co/queueSlave.h>
 #include <co/sendToken.h>
+#include <lunchbox/clock.h>
 #include <lunchbox/rng.h>
 #include <lunchbox/scopedMutex.h>
 #include <lunchbox/plugins/compressor.h>
@@ -66,6 +68,8 @@
 #include <bitset>
 #include <set>
 
+#include "detail/compressorSelector.h"
+#include "detail/imageDelta.h"
 #include "detail/channel.ipp"
 
 #ifdef EQ_USE_SAGE
@@ -83,6 +87,70 @@ using detail::STATE_RUNNING;
 using detail::STATE_FAILED;
 /** @endcond */
 
+namespace
+{
+/** Payloads up to this size are copied into the staging buffer. */
+static const uint64_t _maxStagedItemSize = 16384;
+
+/** The largest number of tiles fetched from a tile queue per request. */
+static const uint32_t _maxTileBatchSize = 64;
+
+typedef std::pair< const void*, uint64_t > SendItem;
+typedef std::vector< SendItem > SendItems;
+typedef SendItems::const_iterator SendItemsCIter;
+
+/**
+ * Send a list of items using as few writes as possible.
+ *
+ * Small items, e.g., image headers and chunk sizes, are coalesced into the
+ * staging buffer. Larger payloads are sent in place without being copied.
+ *
+ * @return the number of writes issued on the connection.
+ */
+uint32_t _sendGathered( co::ConnectionPtr connection, const SendItems& items,
+                        lunchbox::Bufferb& staging )
+{
+    uint32_t nSends = 0;
+    staging.setSize( 0 );
+    for( SendItemsCIter i = items.begin(); i != items.end(); ++i )
+    {
+        const uint64_t size = i->second;
+        if( size == 0 )
+            continue;
+
+        if( size <= _maxStagedItemSize )
+        {
+            staging.append( reinterpret_cast< const uint8_t* >( i->first ),
+                            size );
+            if( staging.getSize() < _maxStagedItemSize )
+                continue;
+        }
+        else if( !staging.isEmpty( ))
+        {
+            connection->send( staging.getData(), staging.getSize(), true );
+            staging.setSize( 0 );
+            ++nSends;
+        }
+
+        if( staging.isEmpty( ))
+            connection->send( i->first, size, true );
+        else
+        {
+            connection->send( staging.getData(), staging.getSize(), true );
+            staging.setSize( 0 );
+        }
+        ++nSends;
+    }
+
+    if( !staging.isEmpty( ))
+    {
+        connection->send( staging.getData(), staging.getSize(), true );
+        ++nSends;
+    }
+    return nSends;
+}
+}
+
 Channel::Channel( Window* parent )
         : Super( parent )
         , _impl( new detail::Channel )
@@ -542,11 +610,34 @@ const View* Channel::getView() const
     return pipe->getView( getContext().view );
 }
 
-co::QueueSlave* Channel::_getQueue( const UUID& queueID )
+co::QueueSlave* Channel::_getQueue( const UUID& queueID,
+                                    const bool prefetch )
 {
     LB_TS_THREAD( _pipeThread );
     Pipe* pipe = getPipe();
-    return pipe->getQueue( queueID );
+    return pipe->getQueue( queueID, prefetch ? _impl->tileBatchSize : 1 );
+}
+
+void Channel::_updateTileBatchSize( const float roundTrip,
+                                    const float tileTime )
+{
+    // smooth the measurements of the last frames
+    _impl->tileRoundTrip = _impl->tileRoundTrip > 0.f ?
+                           .5f * ( _impl->tileRoundTrip + roundTrip ) :
+                           roundTrip;
+    _impl->tileTime = _impl->tileTime > 0.f ?
+                      .5f * ( _impl->tileTime + tileTime ) : tileTime;
+
+    // The queue requests the next batch when half of the current batch is
+    // left. Size batches so that this half hides one round trip. Only powers
+    // of two are used, to not replace the queue slaves on small changes.
+    const float nTiles = 2.f * _impl->tileRoundTrip /
+                         LB_MAX( _impl->tileTime, .001f );
+    uint32_t batchSize = 2;
+    while( batchSize < nTiles && batchSize < _maxTileBatchSize )
+        batchSize <<= 1;
+
+    _impl->tileBatchSize = batchSize;
 }
 
 View* Channel::getNativeView()
@@ -1043,8 +1134,10 @@ private:
 typedef lunchbox::RefPtr< detail::RBStat > RBStatPtr;
 
 void Channel::_frameTiles( RenderContext& context, const bool isLocal,
-                           const UUID& queueID, const uint32_t tasks,
-                           const co::ObjectVersions& frames )
+                           const std::vector< UUID >& queueIDs,
+                           const uint32_t tasks,
+                           const co::ObjectVersions& frames,
+                           const bool costOrder )
 {
     _setRenderContext( context );
 
@@ -1064,15 +1157,56 @@ void Channel::_frameTiles( RenderContext& context, const bool isLocal,
     bool hasAsyncReadback = false;
     const uint32_t timeout = getConfig()->getTimeout();
 
-    co::QueueSlave* queue = _getQueue( queueID );
-    LBASSERT( queue );
+    // per-tile times, used by the server for cost-aware tile ordering
+    const bool tileStatistics = costOrder &&
+                                getIAttribute( IATTR_HINT_STATISTICS ) != OFF;
+    const uint32_t frameNumber = getCurrentFrame();
+    Statistics tileStats;
+
+    lunchbox::Clock loopClock;
+    lunchbox::Clock waitClock;
+    float waitTime = 0.f;
+    float roundTrip = 0.f;
+    uint32_t nTiles = 0;
+
+    // Drain the queues in order. With work stealing, the first queue holds
+    // the private part of the own tile range, the others are shared with other
+    // channels and are not prefetched from.
+    std::vector< UUID >::const_iterator nextQueueID = queueIDs.begin();
+    co::QueueSlave* queue = 0;
+    UUID queueID;
     for( ;; )
     {
+        if( !queue )
+        {
+            if( nextQueueID == queueIDs.end( ))
+                break;
+            const bool prefetch = nextQueueID == queueIDs.begin();
+            queueID = *nextQueueID++;
+            queue = _getQueue( queueID, prefetch );
+            LBASSERT( queue );
+        }
+
+        waitClock.reset();
         co::ObjectICommand tileCmd = queue->pop( timeout );
+        const float wait = waitClock.getTimef();
+        waitTime += wait;
         if( !tileCmd.isValid( ))
-            break;
+        {
+            // An empty reply answers the last outstanding request, a timeout
+            // may leave prefetched items in flight.
+            if( wait < float( timeout ))
+                getPipe()->setQueueDrained( queueID );
+            queue = 0;
+            continue;
+        }
+
+        if( nTiles == 0 ) // nothing prefetched yet: a full round trip
+            roundTrip = wait;
+        ++nTiles;
 
         const Tile& tile = tileCmd.get< Tile >();
+        const int64_t tileStart = getConfig()->getTime();
         context.apply( tile );
 
         const PixelViewport tilePVP = context.pvp;
@@ -1130,6 +1264,45 @@ void Channel::_frameTiles( RenderContext& context, const bool isLocal,
             if( _asyncFinishReadback( nImages ))
                 hasAsyncReadback = true;
         }
+
+        if( tileStatistics )
+        {
+            Statistic tileStat = Statistic();
+            tileStat.type = Statistic::CHANNEL_TILE;
+            tileStat.frameNumber = frameNumber;
+            tileStat.task = getTaskID();
+            tileStat.tile = tile.index;
+            tileStat.startTime = tileStart;
+            tileStat.endTime = getConfig()->getTime();
+            tileStats.push_back( tileStat );
+        }
+    }
+
+    if( nTiles > 0 )
+        _updateTileBatchSize( roundTrip,
+                              ( loopClock.getTimef() - waitTime ) / nTiles );
+
+    if( !tileStats.empty( ))
+    {
+        // server-only load data, not forwarded to the application
+        const size_t index = frameNumber % _impl->statistics->size();
+        lunchbox::ScopedFastWrite mutex( _impl->statistics );
+        Statistics& statistics = _impl->statistics.data[ index ].data;
+        statistics.insert( statistics.end(), tileStats.begin(),
+                           tileStats.end( ));
+    }
+
+    {
+        ChannelStatistics event( Statistic::CHANNEL_TILES, this );
+        event.event.data.statistic.startTime = startTime;
+        event.event.data.statistic.tile = nTiles;
+    }
+
+    {
+        ChannelStatistics event( Statistic::CHANNEL_TILE_WAIT, this );
+        event.event.data.statistic.startTime = startTime;
+        startTime += int64_t( waitTime );
+        event.event.data.statistic.endTime = startTime;
     }
 
     if( tasks & fabric::TASK_CLEAR )
@@ -1254,29 +1427,51 @@ bool Channel::_asyncFinishReadback( const std::vector< size_t >& imagePos )
         const std::vector< uint128_t >& nodes = frame->getInputNodes( eye );
         const std::vector< uint128_t >& netNodes = frame->getInputNetNodes(eye);
 
+        // Split all images before handing any of them to the transfer thread,
+        // since adding images may reallocate the image vector it reads.
+        std::vector< uint64_t > transmit;
         for( uint64_t j = imagePos[i]; j < nImages; ++j )
         {
-            if( images[j]->hasAsyncReadback( )) // finish async readback
-            {
-                LBCHECK( getPipe()->startTransferThread( ));
-                LBCHECK( getWindow()->createTransferWindow( ));
+            if( images[j]->hasAsyncReadback() || nodes.empty( ))
+                continue;
 
-                hasAsyncReadback = true;
-                _refFrame( frameNumber );
+            const size_t first = images.size();
+            if( !_reduceImage( frameData, j, true ))
+                continue; // background only
 
-                send( getLocalNode(), fabric::CMD_CHANNEL_FINISH_READBACK )
-                        << co::ObjectVersion( frameData ) << j << frameNumber
-                        << getTaskID() << nodes << netNodes;
-            }
-            else // transmit images asynchronously
-                _asyncTransmit( frameData, frameNumber, j, nodes, netNodes,
-                                getTaskID( ));
+            transmit.push_back( j );
+            for( uint64_t k = first; k < images.size(); ++k )
+                transmit.push_back( k );
+        }
+
+        for( uint64_t j = imagePos[i]; j < nImages; ++j )
+        {
+            if( !images[j]->hasAsyncReadback( ))
+                continue;
+
+            // finish async readback
+            LBCHECK( getPipe()->startTransferThread( ));
+            LBCHECK( getWindow()->createTransferWindow( ));
+
+            hasAsyncReadback = true;
+            _refFrame( frameNumber );
+
+            send( getLocalNode(), fabric::CMD_CHANNEL_FINISH_READBACK )
+                    << co::ObjectVersion( frameData ) << frame->getID()
+                    << uint32_t( eye ) << j << frameNumber << getTaskID()
+                    << nodes << netNodes;
         }
+
+        // transmit images asynchronously
+        for( size_t j = 0; j < transmit.size(); ++j )
+            _asyncTransmit( frameData, frame->getID(), eye, frameNumber,
+                            transmit[j], nodes, netNodes, getTaskID( ));
     }
     return hasAsyncReadback;
 }
 
 void Channel::_finishReadback( const co::ObjectVersion& frameDataVersion,
+                               const uint128_t& frameID, const Eye eye,
                                const uint64_t imageIndex,
                                const uint32_t frameNumber,
                                const uint32_t taskID,
@@ -1297,11 +1492,67 @@ void Channel::_finishReadback( const co::ObjectVersion& frameDataVersion,
     LBASSERT( !image->hasAsyncReadback( ));
 
     // schedule async image tranmission
-    _asyncTransmit( frameData, frameNumber, imageIndex, nodes,
+    if( !nodes.empty() && !_reduceImage( frameData, imageIndex, false ))
+        return; // background only
+    _asyncTransmit( frameData, frameID, eye, frameNumber, imageIndex, nodes,
                     netNodes, taskID );
 }
 
-void Channel::_asyncTransmit( FrameDataPtr frame, const uint32_t frameNumber,
+bool Channel::_reduceImage( FrameDataPtr frameData, const uint64_t index,
+                            const bool split )
+{
+    // delta transmission tracks the last image sent per image index
+    if( frameData->useDeltaTransmission( ))
+        return true;
+
+    // Pixel decompositions and zoomed images store the offset in destination
+    // units with the decimated or zoomed size, which the regions can't be
+    // mapped to.
+    Image* image = frameData->getImages()[ index ];
+    if( frameData->getPixel() != Pixel::ALL ||
+        frameData->getZoom() != Zoom::NONE || image->getZoom() != Zoom::NONE )
+    {
+        return true;
+    }
+
+    ROIFinder& finder = split ? _impl->roiFinder : _impl->transferROIFinder;
+    const PixelViewports regions = finder.findRegions( *image );
+    if( regions.empty( ))
+        return false;
+
+    const PixelViewport& pvp = image->getPixelViewport();
+    if( regions.size() == 1 && regions[0] == pvp )
+        return true;
+
+    PixelViewport bounds;
+    uint64_t area = 0;
+    for( size_t i = 0; i < regions.size(); ++i )
+    {
+        bounds.merge( regions[i] );
+        area += regions[i].getArea();
+    }
+
+    // Only the pipe thread may add images to the frame data, the transfer
+    // thread crops to the bounding box of all regions.
+    if( !split || regions.size() == 1 ||
+        area * 4 > uint64_t( bounds.getArea( )) * 3 )
+    {
+        LBCHECK( image->crop( bounds ));
+        return true;
+    }
+
+    for( size_t i = 1; i < regions.size(); ++i )
+    {
+        Image* part = frameData->newImage( Frame::TYPE_MEMORY,
+                                           getDrawableConfig( ));
+        LBCHECK( part->setPixelData( *image, regions[i] ));
+    }
+    LBCHECK( image->crop( regions[0] ));
+    return true;
+}
+
+void Channel::_asyncTransmit( FrameDataPtr frame, const uint128_t& frameID,
+                              const Eye eye, const uint32_t frameNumber,
                               const uint64_t image,
                               const std::vector<uint128_t>& nodes,
                               const std::vector< uint128_t >& netNodes,
@@ -1318,12 +1569,13 @@ void Channel::_asyncTransmit( FrameDataPtr frame, const uint32_t frameNumber,
                                         << " receiver " << *i << " on " << *j
                                         << std::endl;
         send( getLocalNode(), fabric::CMD_CHANNEL_FRAME_TRANSMIT_IMAGE )
-                << co::ObjectVersion( frame ) << *i << *j << image
-                << frameNumber << taskID;
+                << co::ObjectVersion( frame ) << frameID << uint32_t( eye )
+                << *i << *j << image << frameNumber << taskID;
     }
 }
 
 void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
+                              const uint128_t& frameID, const Eye eye,
                               const uint128_t& nodeID,
                               const uint128_t& netNodeID,
                               const uint64_t imageIndex,
@@ -1343,6 +1595,7 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
     ChannelStatistics transmitEvent( Statistic::CHANNEL_FRAME_TRANSMIT, this,
                                      frameNumber );
     transmitEvent.event.data.statistic.task = taskID;
+    transmitEvent.event.data.statistic.sends = 0;
 
     const Images& images = frameData->getImages();
     Image* image = images[ imageIndex ];
@@ -1367,11 +1620,15 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
     co::ConnectionPtr connection = toNode->getConnection();
     co::ConstConnectionDescriptionPtr description =connection->getDescription();
 
-    // use compression on links up to 2 GBit/s
-    const bool useCompression = ( description->bandwidth <= 262144 );
+    detail::CompressorSelector& selector =
+        _impl->compressorSelectors[ netNodeID ];
+    lunchbox::Clock clock;
 
     std::vector< const PixelData* > pixelDatas;
     std::vector< float > qualities;
+    std::vector< uint32_t > deltaModes;
+    std::vector< uint64_t > deltaBlocks[2];
+    bool uncompressed[2] = { false, false };
 
     uint32_t commandBuffers = Frame::BUFFER_NONE;
     uint64_t imageDataSize = 0;
@@ -1380,8 +1637,7 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
     {
         uint64_t rawSize( 0 );
         ChannelStatistics compressEvent( Statistic::CHANNEL_FRAME_COMPRESS,
-                                         this, frameNumber,
-                                         useCompression ? AUTO : OFF );
+                                         this, frameNumber );
         compressEvent.event.data.statistic.task = taskID;
         compressEvent.event.data.statistic.ratio = 1.0f;
         compressEvent.event.data.statistic.plugins[0] = EQ_COMPRESSOR_NONE;
@@ -1398,15 +1654,76 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
             {
                 // format, type, nChunks, compressor name
                 imageDataSize += sizeof( FrameData::ImageHeader );
+                commandBuffers |= buffer;
+                rawSize += image->getPixelDataSize( buffer );
+                qualities.push_back( image->getQuality( buffer ));
 
-                const PixelData& data = useCompression ?
-                    image->compressPixelData( buffer ) :
-                    image->getPixelData( buffer );
+                // send only the changed blocks if most of the image is as
+                // last sent to this node
+                uint32_t deltaMode = detail::DELTA_NONE;
+                if( frameData->useDeltaTransmission( ))
+                {
+                    detail::ImageDelta& delta =
+                        _impl->imageDeltas.get( netNodeID, frameID, eye,
+                                                imageIndex, buffer );
+                    std::vector< uint64_t >& blocks =
+                        deltaBlocks[ pixelDatas.size() ];
+                    const PixelData& data = image->getPixelData( buffer );
+
+                    if( delta.encode( data, blocks ) &&
+                        blocks.size() * 2 < delta.getNumBlocks( ))
+                    {
+                        const uint64_t size = image->getPixelDataSize( buffer );
+                        for( size_t k = 0; k < blocks.size(); ++k )
+                            imageDataSize += sizeof( uint64_t ) +
+                                detail::ImageDelta::getBlockSize( blocks[k],
+                                                                  size );
+                        pixelDatas.push_back( &data );
+                        deltaModes.push_back( detail::DELTA_BLOCKS );
+                        continue;
+                    }
+                    deltaMode = detail::DELTA_BASE;
+                }
+                deltaModes.push_back( deltaMode );
+
+                // Choose the compressor unless the application did, or the
+                // image was already compressed for another destination. A
+                // delta base has to arrive exactly as the sender keeps it.
+                const bool lossless = deltaMode == detail::DELTA_BASE;
+                const PixelData& raw = image->getPixelData( buffer );
+                const bool compressed = raw.isCompressed;
+                if( !compressed &&
+                    raw.compressorName == EQ_COMPRESSOR_AUTO )
+                {
+                    image->useCompressor( buffer,
+                                          selector.choose( *image, buffer,
+                                                   description->bandwidth,
+                                                   lossless ));
+                }
+
+                clock.reset();
+                const PixelData& data = image->compressPixelData( buffer );
+                if( !compressed && data.isCompressed )
+                {
+                    uint64_t compressedSize = 0;
+                    for( size_t k = 0; k < data.compressedSize.size(); ++k )
+                        compressedSize += data.compressedSize[ k ];
+                    selector.addCompression( data.compressorName,
+                                             image->getPixelDataSize( buffer ),
+                                             compressedSize,
+                                             clock.getTimef( ));
+                }
+
+                // send a lossy compressed delta base as raw pixels
+                const bool sendRaw = lossless && data.isCompressed &&
+                    !selector.isLossless( *image, buffer, data.compressorName );
+                uncompressed[ pixelDatas.size() ] = sendRaw;
                 pixelDatas.push_back( &data );
-                qualities.push_back( image->getQuality( buffer ));
 
-                if( data.isCompressed )
+                if( data.isCompressed && !sendRaw )
                 {
+                    imageDataSize += data.compressedStripes.size() *
+                                     sizeof( uint64_t );
                     const uint32_t nElements =
                         uint32_t( data.compressedSize.size( ));
                     for( uint32_t k = 0 ; k < nElements; ++k )
@@ -1422,9 +1739,6 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
                     imageDataSize += sizeof( uint64_t );
                     imageDataSize += image->getPixelDataSize( buffer );
                 }
-
-                commandBuffers |= buffer;
-                rawSize += image->getPixelDataSize( buffer );
             }
         }
 
@@ -1453,58 +1767,107 @@ void Channel::_transmitImage( const co::ObjectVersion& frameDataVersion,
                                 co::COMMANDTYPE_OBJECT, nodeID,
                                 EQ_INSTANCE_ALL );
     command << frameDataVersion << image->getPixelViewport() << image->getZoom()
-            << commandBuffers << frameNumber << image->getAlphaUsage();
+            << commandBuffers << frameNumber << image->getAlphaUsage()
+            << getID() << frameID << uint32_t( eye ) << imageIndex;
     command.sendHeader( imageDataSize );
 
-#ifndef NDEBUG
-    size_t sentBytes = 0;
-#endif
-
+    // Gather header, chunk sizes and chunk payloads of all attachments into
+    // one send list. The sizes, preceded by the number of chunks of each
+    // compression stripe, precede the payloads, so that the metadata of one
+    // attachment goes out in a single write. Deltas send the indices of the
+    // changed blocks instead of the sizes.
+    FrameData::ImageHeader headers[2];
+    std::vector< uint64_t > sizes;
     for( uint32_t j=0; j < pixelDatas.size(); ++j )
     {
-#ifndef NDEBUG
-        sentBytes += sizeof( FrameData::ImageHeader );
-#endif
         const PixelData* data = pixelDatas[j];
+        if( deltaModes[j] == detail::DELTA_BLOCKS )
+        {
+            const FrameData::ImageHeader header =
+                  { data->internalFormat, data->externalFormat,
+                    data->pixelSize, data->pvp, EQ_COMPRESSOR_NONE, 0,
+                    uint32_t( deltaBlocks[j].size( )), 0, deltaModes[j],
+                    qualities[ j ] };
+            headers[j] = header;
+            sizes.insert( sizes.end(), deltaBlocks[j].begin(),
+                          deltaBlocks[j].end( ));
+            continue;
+        }
+
+        const bool compressed = data->isCompressed && !uncompressed[j];
+        const uint32_t nStripes = compressed ?
+                                  uint32_t( data->compressedStripes.size( )) : 0;
         const FrameData::ImageHeader header =
               { data->internalFormat, data->externalFormat,
                 data->pixelSize, data->pvp,
-                useCompression ? data->compressorName : EQ_COMPRESSOR_NONE,
+                compressed ? data->compressorName : EQ_COMPRESSOR_NONE,
                 data->compressorFlags,
-                data->isCompressed ? uint32_t( data->compressedSize.size()) : 1,
+                compressed ? uint32_t( data->compressedSize.size()) : 1,
+                nStripes, deltaModes[j],
                 qualities[ j ] };
+        headers[j] = header;
 
-        connection->send( &header, sizeof( header ), true );
+        if( compressed )
+        {
+            sizes.insert( sizes.end(), data->compressedStripes.begin(),
+                          data->compressedStripes.end( ));
+            sizes.insert( sizes.end(), data->compressedSize.begin(),
+                          data->compressedSize.end( ));
+        }
+        else
+            sizes.push_back( data->pvp.getArea() * data->pixelSize );
+    }
+
+    SendItems items;
+    const uint64_t* chunkSizes = sizes.empty() ? 0 : &sizes.front();
+    for( uint32_t j=0; j < pixelDatas.size(); ++j )
+    {
+        const PixelData* data = pixelDatas[j];
+        const uint32_t nChunks = headers[j].nChunks;
+        const uint32_t nSizes = nChunks + headers[j].nStripes;
 
-        if( data->isCompressed )
+        items.push_back( SendItem( &headers[j], sizeof( headers[j] )));
+        items.push_back( SendItem( chunkSizes, nSizes * sizeof( uint64_t )));
+
+        if( deltaModes[j] == detail::DELTA_BLOCKS )
         {
-            for( uint32_t k = 0 ; k < data->compressedSize.size(); ++k )
+            const uint8_t* pixels =
+                reinterpret_cast< const uint8_t* >( data->pixels );
+            const uint64_t size = uint64_t( data->pvp.getArea( )) *
+                                  data->pixelSize;
+            for( uint32_t k = 0 ; k < nChunks; ++k )
             {
-                const uint64_t dataSize = data->compressedSize[k];
-                connection->send( &dataSize, sizeof( dataSize ), true );
-                if( dataSize > 0 )
-                    connection->send( data->compressedData[k],
-                                      dataSize, true );
-#ifndef NDEBUG
-                sentBytes += sizeof( dataSize ) + dataSize;
-#endif
+                const uint64_t block = chunkSizes[k];
+                items.push_back( SendItem(
+                    pixels + block * detail::ImageDelta::blockSize,
+                    detail::ImageDelta::getBlockSize( block, size )));
             }
         }
-        else
+        else if( data->isCompressed && !uncompressed[j] )
         {
-            const uint64_t dataSize = data->pvp.getArea() *
-                data->pixelSize;
-            connection->send( &dataSize, sizeof( dataSize ), true );
-            connection->send( data->pixels, dataSize, true );
-#ifndef NDEBUG
-            sentBytes += sizeof( dataSize ) + dataSize;
-#endif
+            for( uint32_t k = 0 ; k < nChunks; ++k )
+                items.push_back( SendItem( data->compressedData[k],
+                                           data->compressedSize[k] ));
         }
+        else
+            items.push_back( SendItem( data->pixels, *chunkSizes ));
+        chunkSizes += nSizes;
     }
+
 #ifndef NDEBUG
+    size_t sentBytes = 0;
+    for( SendItemsCIter i = items.begin(); i != items.end(); ++i )
+        sentBytes += i->second;
     LBASSERTINFO( sentBytes == imageDataSize,
         sentBytes << " != " << imageDataSize );
 #endif
+
+    lunchbox::Bufferb& staging = _impl->sendStaging;
+    staging.reserve( _maxStagedItemSize * 2 ); // allocates only once
+    clock.reset();
+    transmitEvent.event.data.statistic.sends =
+        _sendGathered( connection, items, staging );
+    selector.addTransmission( imageDataSize, clock.getTimef( ));
 }
 
 void Channel::_setReady( const bool async, detail::RBStat* stat )
@@ -1810,6 +2173,8 @@ bool Channel::_cmdFinishReadback( co::ICommand& cmd )
                                     << std::endl;
 
     const co::ObjectVersion frameData = command.get< co::ObjectVersion >();
+    const uint128_t frameID = command.get< uint128_t >();
+    const Eye eye = Eye( command.get< uint32_t >( ));
     const uint64_t imageIndex = command.get< uint64_t >();
     const uint32_t frameNumber = command.get< uint32_t >();
     const uint32_t taskID = command.get< uint32_t >();
@@ -1819,8 +2184,8 @@ bool Channel::_cmdFinishReadback( co::ICommand& cmd )
                                       command.get< std::vector< uint128_t > >();
 
     getWindow()->makeCurrentTransfer();
-    _finishReadback( frameData, imageIndex, frameNumber, taskID, nodes,
-                     netNodes );
+    _finishReadback( frameData, frameID, eye, imageIndex, frameNumber, taskID,
+                     nodes, netNodes );
     _unrefFrame( frameNumber );
     return true;
 }
@@ -1851,6 +2216,8 @@ bool Channel::_cmdFrameTransmitImage( co::ICommand& cmd )
 {
     co::ObjectICommand command( cmd );
     const co::ObjectVersion frameData = command.get< co::ObjectVersion >();
+    const uint128_t frameID = command.get< uint128_t >();
+    const Eye eye = Eye( command.get< uint32_t >( ));
     const uint128_t nodeID = command.get< uint128_t >();
     const uint128_t netNodeID = command.get< uint128_t >();
     const uint64_t imageIndex = command.get< uint64_t >();
@@ -1861,8 +2228,8 @@ bool Channel::_cmdFrameTransmitImage( co::ICommand& cmd )
                                     << frameData << " receiver " << nodeID
                                     << " on " << netNodeID << std::endl;
 
-    _transmitImage( frameData, nodeID, netNodeID, imageIndex, frameNumber,
-                    taskID );
+    _transmitImage( frameData, frameID, eye, nodeID, netNodeID, imageIndex,
+                    frameNumber, taskID );
     _unrefFrame( frameNumber );
     return true;
 }
@@ -1945,14 +2312,16 @@ bool Channel::_cmdFrameTiles( co::ICommand& cmd )
     co::ObjectICommand command( cmd );
     RenderContext context = command.get< RenderContext >();
     const bool isLocal = command.get< bool >();
-    const UUID& queueID = command.get< UUID >();
+    const std::vector< UUID > queueIDs =
+        command.get< std::vector< UUID > >();
     const uint32_t tasks = command.get< uint32_t >();
     const co::ObjectVersions frames = command.get< co::ObjectVersions >();
+    const bool costOrder = command.get< bool >();
 
     LBLOG( LOG_TASKS ) << "TASK channel frame tiles " << getName() <<  " "
                        << command << " " << context << std::endl;
 
-    _frameTiles( context, isLocal, queueID, tasks, frames );
+    _frameTiles( context, isLocal, queueIDs, tasks, frames, costOrder );
     return true;
 }
 
@@ -21,6 +21,7 @@
 #define EQ_CHANNEL_H
 
 #include <eq/client/api.h>
+#include <eq/client/eye.h>           // Eye enum
 #include <eq/client/types.h>
 
 #include <eq/fabric/channel.h>        // base class
@@ -581,8 +582,10 @@ namespace detail { class Channel; struct RBStat; }
 
         /** Tile render loop. */
         void _frameTiles( RenderContext& context, const bool isLocal,
-                          const UUID& queueID, const uint32_t tasks,
-                          const co::ObjectVersions& frames );
+                          const std::vector< UUID >& queueIDs,
+                          const uint32_t tasks,
+                          const co::ObjectVersions& frames,
+                          const bool costOrder );
 
         /** Reference the frame for an async operation. */
         void _refFrame( const uint32_t frameNumber );
@@ -592,6 +595,7 @@ namespace detail { class Channel; struct RBStat; }
 
         /** Transmit one image of a frame to one node. */
         void _transmitImage( const co::ObjectVersion& frameDataVersion,
+                             const uint128_t& frameID, const Eye eye,
                              const uint128_t& nodeID,
                              const uint128_t& netNodeID,
                              const uint64_t imageIndex,
@@ -601,6 +605,7 @@ namespace detail { class Channel; struct RBStat; }
         void _frameReadback( const uint128_t& frameID,
                              const co::ObjectVersions& frames );
         void _finishReadback( const co::ObjectVersion& frameDataVersion,
+                              const uint128_t& frameID, const Eye eye,
                               const uint64_t imageIndex,
                               const uint32_t frameNumber,
                               const uint32_t taskID,
@@ -609,7 +614,18 @@ namespace detail { class Channel; struct RBStat; }
 
         bool _asyncFinishReadback( const std::vector< size_t >& imagePos );
 
-        void _asyncTransmit( FrameDataPtr frame, const uint32_t frameNumber,
+        /**
+         * Reduce a memory image to its foreground before transmission.
+         *
+         * Splits the image into one image per region of interest, or crops
+         * it to their bounding box if not split.
+         * @return false if the image contains only background.
+         */
+        bool _reduceImage( FrameDataPtr frameData, const uint64_t index,
+                           const bool split );
+
+        void _asyncTransmit( FrameDataPtr frame, const uint128_t& frameID,
+                             const Eye eye, const uint32_t frameNumber,
                              const uint64_t image,
                              const std::vector<uint128_t>& nodes,
                              const std::vector< uint128_t >& netNodes,
@@ -624,8 +640,17 @@ namespace detail { class Channel; struct RBStat; }
                         const std::vector< uint128_t >& nodes,
                         const std::vector< uint128_t >& netNodes );
 
-        /** Get the channel's current input queue. */
-        co::QueueSlave* _getQueue( const UUID& queueID );
+        /**
+         * Get an input queue, prefetching tiles only if requested.
+         *
+         * Shared queues are popped one tile at a time, since prefetched tiles
+         * can't be stolen by other channels anymore.
+         */
+        co::QueueSlave* _getQueue( const UUID& queueID, const bool prefetch );
+
+        /** Adapt the tile batch size to the last tile task's timing. */
+        void _updateTileBatchSize( const float roundTrip,
+                                   const float tileTime );
 
         void _setOutputFrames( const co::ObjectVersions& frames );
         void _resetOutputFrames();
@@ -33,6 +33,7 @@
 #include "server.h"
 #include "window.h"
 #include "windowSystem.h"
+#include "detail/compositorKernels.h"
 
 #include <eq/util/accum.h>
 #include <eq/util/frameBufferObject.h>
@@ -65,6 +66,9 @@ static const char* depthDBKey  = shaderDBKey + 2;
 // Image used for CPU-based assembly
 static lunchbox::PerThread< Image > _resultImage;
 
+// Destination bytes merged at once by the CPU compositor, sized to stay in L2
+static const size_t _mergeBandSize = 256 * 1024;
+
 static bool _useCPUAssembly( const Frames& frames, Channel* channel,
                              const bool blendAlpha = false )
 {
@@ -201,6 +205,67 @@ static bool _useCPUAssembly( const Frames& frames, Channel* channel,
     }
     return (nImages > 1);
 }
+
+// Allocate a result image buffer, cleared to the background value
+static void _allocResult( Image* result, const Frame::Buffer buffer,
+                          const PixelData& format )
+{
+    PixelData pixels;
+    pixels.internalFormat = format.internalFormat;
+    pixels.externalFormat = format.externalFormat;
+    pixels.pixelSize      = format.pixelSize;
+    pixels.pvp            = result->getPixelViewport();
+    result->setPixelData( buffer, pixels );
+}
+
+// Enlarge the result image to cover pvp, keeping the already merged pixels
+static void _growResult( Image* result, const PixelViewport& pvp )
+{
+    const PixelViewport oldPVP = result->getPixelViewport();
+    PixelViewport newPVP = oldPVP;
+    newPVP.merge( pvp );
+    if( newPVP == oldPVP )
+        return;
+
+    const Frame::Buffer buffers[] = { Frame::BUFFER_COLOR,
+                                      Frame::BUFFER_DEPTH };
+    lunchbox::Bufferb oldPixels[2];
+    PixelData formats[2];
+    for( unsigned i = 0; i < 2; ++i )
+    {
+        const Frame::Buffer buffer = buffers[i];
+        if( !result->hasPixelData( buffer ))
+            continue;
+
+        const PixelData& data = result->getPixelData( buffer );
+        formats[i].internalFormat = data.internalFormat;
+        formats[i].externalFormat = data.externalFormat;
+        formats[i].pixelSize      = data.pixelSize;
+        oldPixels[i].resize( result->getPixelDataSize( buffer ));
+        memcpy( oldPixels[i].getData(), data.pixels, oldPixels[i].getSize( ));
+    }
+
+    LBLOG( LOG_ASSEMBLY ) << "Grow CPU assembly result from " << oldPVP
+                          << " to " << newPVP << std::endl;
+    result->setPixelViewport( newPVP );
+    for( unsigned i = 0; i < 2; ++i )
+    {
+        if( formats[i].pixelSize == 0 )
+            continue;
+
+        const Frame::Buffer buffer = buffers[i];
+        _allocResult( result, buffer, formats[i] );
+
+        const size_t pixelSize = formats[i].pixelSize;
+        const size_t rowSize = oldPVP.w * pixelSize;
+        uint8_t* dest = result->getPixelPointer( buffer ) +
+                        ( ( oldPVP.y - newPVP.y ) * newPVP.w +
+                          oldPVP.x - newPVP.x ) * pixelSize;
+        for( int32_t y = 0; y < oldPVP.h; ++y )
+            memcpy( dest + y * newPVP.w * pixelSize,
+                    oldPixels[i].getData() + y * rowSize, rowSize );
+    }
+}
 }
 
 uint32_t Compositor::assembleFrames( const Frames& frames,
@@ -421,8 +486,10 @@ uint32_t Compositor::assembleFramesUnsorted( const Frames& frames,
 class Compositor::WaitHandle
 {
 public:
-    WaitHandle( const Frames& frames, Channel* ch )
-            : left( frames ), channel( ch ), processed( 0 ) {}
+    WaitHandle( const Frames& frames, Channel* ch,
+                const uint32_t timeout_ = LB_TIMEOUT_INDEFINITE )
+            : left( frames ), channel( ch ), timeout( timeout_ )
+            , processed( 0 ) {}
     ~WaitHandle()
         {
             // de-register the monitor on eventual left-overs on error/exception
@@ -433,7 +500,8 @@ public:
 
     lunchbox::Monitor< uint32_t > monitor;
     Frames left;
-    Channel* const channel;
+    Channel* const channel; //!< 0 for channel-less waits, e.g., CPU merge
+    const uint32_t timeout; //!< used for channel-less waits only
     uint32_t processed;
 };
 
@@ -455,12 +523,22 @@ Frame* Compositor::waitFrame( WaitHandle* handle )
         return 0;
     }
 
+    ++handle->processed;
+    if( !handle->channel )
+    {
+        if( !handle->monitor.timedWaitGE( handle->processed, handle->timeout ))
+        {
+            delete handle;
+            throw Exception( Exception::TIMEOUT_INPUTFRAME );
+        }
+        return _popReadyFrame( handle );
+    }
+
     ChannelStatistics event( Statistic::CHANNEL_FRAME_WAIT_READY,
                              handle->channel );
     Config* config = handle->channel->getConfig();
     const uint32_t timeout = config->getTimeout();
 
-    ++handle->processed;
     if( timeout == LB_TIMEOUT_INDEFINITE )
         handle->monitor.waitGE( handle->processed );
     else
@@ -486,6 +564,11 @@ Frame* Compositor::waitFrame( WaitHandle* handle )
         }
     }
 
+    return _popReadyFrame( handle );
+}
+
+Frame* Compositor::_popReadyFrame( WaitHandle* handle )
+{
     for( FramesIter i = handle->left.begin(); i != handle->left.end(); ++i )
     {
         Frame* frame = *i;
@@ -513,8 +596,8 @@ uint32_t Compositor::assembleFramesCPU( const Frames& frames, Channel* channel,
     // assembles the result image. Does not yet support Pixel or Eye
     // compounds.
 
-    const Image* result = mergeFramesCPU( frames, blendAlpha,
-                                          channel->getConfig()->getTimeout( ));
+    const Image* result = _mergeFramesCPU( frames, blendAlpha, channel,
+                                           channel->getConfig()->getTimeout( ));
     if( !result )
         return 0;
 
@@ -538,64 +621,172 @@ const Image* Compositor::mergeFramesCPU( const Frames& frames,
                                          const bool blendAlpha,
                                          const uint32_t timeout )
 {
-    LBVERB << "Sorted CPU assembly" << std::endl;
-
-    // Collect input image information and check preconditions
-    PixelViewport destPVP;
-    uint32_t colorInternalFormat    = 0;
-    uint32_t colorExternalFormat    = 0;
-    uint32_t colorPixelSize         = 0;
-    uint32_t depthInternalFormat    = 0;
-    uint32_t depthExternalFormat    = 0;
-    uint32_t depthPixelSize         = 0;
-
-    if( !_collectOutputData( frames, destPVP,
-                             colorInternalFormat, colorPixelSize,
-                             colorExternalFormat,
-                             depthInternalFormat, depthPixelSize,
-                             depthExternalFormat, timeout ))
-    {
-        return 0;
-    }
+    return _mergeFramesCPU( frames, blendAlpha, 0, timeout );
+}
 
+const Image* Compositor::_mergeFramesCPU( const Frames& frames,
+                                          const bool blendAlpha,
+                                          Channel* channel,
+                                          const uint32_t timeout )
+{
     // prepare output image
     if( !_resultImage )
         _resultImage = new Image;
     Image* result = _resultImage.get();
+    result->setPixelViewport( PixelViewport( ));
 
-    // pre-condition check for current _merge implementations
-    LBASSERT( colorInternalFormat != 0 );
+    // Color-only images merged before the first depth image
+    PixelViewports colorOnly;
 
-    result->setPixelViewport( destPVP );
+    if( blendAlpha )
+    {
+        LBVERB << "Sorted CPU assembly" << std::endl;
 
-    PixelData colorPixels;
-    colorPixels.internalFormat = colorInternalFormat;
-    colorPixels.externalFormat = colorExternalFormat;
-    colorPixels.pixelSize      = colorPixelSize;
-    colorPixels.pvp            = destPVP;
-    result->setPixelData( Frame::BUFFER_COLOR, colorPixels );
+        // Blending is order-dependent: merge each frame as soon as it and all
+        // its predecessors are ready
+        for( FramesCIter i = frames.begin(); i != frames.end(); ++i )
+        {
+            Frame* frame = *i;
+            if( channel )
+            {
+                ChannelStatistics event( Statistic::CHANNEL_FRAME_WAIT_READY,
+                                         channel );
+                frame->waitReady( timeout );
+            }
+            else
+                frame->waitReady( timeout );
 
-    void* destDepth = 0;
-    if( depthInternalFormat != 0 ) // at least one depth assembly
+            if( !_mergeFrameCPU( frame, blendAlpha, result, colorOnly ))
+                return 0;
+        }
+    }
+    else
     {
-        LBASSERT( depthExternalFormat ==
-                  EQ_COMPRESSOR_DATATYPE_DEPTH_UNSIGNED_INT );
-        PixelData depthPixels;
-        depthPixels.internalFormat = depthInternalFormat;
-        depthPixels.externalFormat = depthExternalFormat;
-        depthPixels.pixelSize      = depthPixelSize;
-        depthPixels.pvp            = destPVP;
-        result->setPixelData( Frame::BUFFER_DEPTH, depthPixels );
-        destDepth = result->getPixelPointer( Frame::BUFFER_DEPTH );
+        LBVERB << "Unsorted CPU assembly" << std::endl;
+
+        // Depth-based and 2D assembly: merge frames in the order they arrive,
+        // overlapping the network transfer of the others
+        WaitHandle* handle = 0;
+        if( channel )
+            handle = startWaitFrames( frames, channel );
+        else
+        {
+            handle = new WaitHandle( frames, 0, timeout );
+            for( FramesCIter i = frames.begin(); i != frames.end(); ++i )
+                (*i)->addListener( handle->monitor );
+        }
+
+        for( Frame* frame = waitFrame( handle ); frame;
+             frame = waitFrame( handle ))
+        {
+            if( !_mergeFrameCPU( frame, blendAlpha, result, colorOnly ))
+            {
+                delete handle;
+                return 0;
+            }
+        }
     }
 
-    // assembly
-    _mergeFrames( frames, blendAlpha,
-                  result->getPixelPointer( Frame::BUFFER_COLOR ),
-                  destDepth, destPVP );
+    if( !result->getPixelViewport().hasArea( ))
+    {
+        LBWARN << "Nothing to assemble" << std::endl;
+        return 0;
+    }
     return result;
 }
 
+bool Compositor::_mergeFrameCPU( Frame* frame, const bool blendAlpha,
+                                 Image* result, PixelViewports& colorOnly )
+{
+#ifdef EQ_2_0_API
+    LBASSERTINFO( frame->getPixel() == Pixel::ALL &&
+                  frame->getSubPixel() == SubPixel::ALL &&
+                  frame->getFrameData()->getZoom() == Zoom::NONE &&
+                  frame->getZoom() == Zoom::NONE,
+                  "CPU-based compositing not implemented for given frames");
+#else
+    LBASSERTINFO( frame->getPixel() == Pixel::ALL &&
+                  frame->getSubPixel() == SubPixel::ALL &&
+                  frame->getData()->getZoom() == Zoom::NONE &&
+                  frame->getZoom() == Zoom::NONE,
+                  "CPU-based compositing not implemented for given frames");
+#endif
+    if( frame->getPixel() != Pixel::ALL )
+        return false;
+
+    // Grow the result image to cover the new images. Input frame data is only
+    // known once the frame is ready, so the result can't be sized up front.
+    const Images& images = frame->getImages();
+    bool hasData = false;
+    for( ImagesCIter i = images.begin(); i != images.end(); ++i )
+    {
+        const Image* image = *i;
+        LBASSERT( image->getStorageType() == Frame::TYPE_MEMORY );
+        if( image->getStorageType() != Frame::TYPE_MEMORY )
+            return false;
+
+        if( !image->hasPixelData( Frame::BUFFER_COLOR ))
+            continue;
+
+        const PixelViewport pvp = image->getPixelViewport() +
+                                  frame->getOffset();
+        if( result->getPixelViewport().hasArea( ))
+        {
+            LBASSERT( image->getExternalFormat( Frame::BUFFER_COLOR ) ==
+                      result->getExternalFormat( Frame::BUFFER_COLOR ));
+            _growResult( result, pvp );
+        }
+        else
+        {
+            result->setPixelViewport( pvp );
+            _allocResult( result, Frame::BUFFER_COLOR,
+                          image->getPixelData( Frame::BUFFER_COLOR ));
+        }
+        hasData = true;
+
+        if( image->hasPixelData( Frame::BUFFER_DEPTH ))
+        {
+            if( result->hasPixelData( Frame::BUFFER_DEPTH ))
+                continue;
+
+            LBASSERT( image->getExternalFormat( Frame::BUFFER_DEPTH ) ==
+                      EQ_COMPRESSOR_DATATYPE_DEPTH_UNSIGNED_INT );
+            _allocResult( result, Frame::BUFFER_DEPTH,
+                          image->getPixelData( Frame::BUFFER_DEPTH ));
+
+            // color-only images merged so far are in front of any depth image
+            const PixelViewport& destPVP = result->getPixelViewport();
+            uint32_t* depth = reinterpret_cast< uint32_t* >(
+                result->getPixelPointer( Frame::BUFFER_DEPTH ));
+            for( PixelViewportsCIter j = colorOnly.begin();
+                 j != colorOnly.end(); ++j )
+            {
+                const PixelViewport& region = *j;
+                for( int32_t y = region.y; y < region.getYEnd(); ++y )
+                    lunchbox::setZero( depth + ( y - destPVP.y ) * destPVP.w +
+                                       region.x - destPVP.x,
+                                       region.w * sizeof( uint32_t ));
+            }
+            colorOnly.clear();
+        }
+        else if( !( blendAlpha && image->hasAlpha( )) &&
+                 !result->hasPixelData( Frame::BUFFER_DEPTH ))
+        {
+            colorOnly.push_back( pvp );
+        }
+    }
+
+    if( !hasData )
+        return true;
+
+    void* destDepth = result->hasPixelData( Frame::BUFFER_DEPTH ) ?
+                      result->getPixelPointer( Frame::BUFFER_DEPTH ) : 0;
+    _mergeFrames( Frames( 1, frame ), blendAlpha,
+                  result->getPixelPointer( Frame::BUFFER_COLOR ), destDepth,
+                  result->getPixelViewport( ));
+    return true;
+}
+
 bool Compositor::_collectOutputData(
          const Frames& frames, PixelViewport& destPVP,
          uint32_t& colorInternalFormat, uint32_t& colorPixelSize,
@@ -759,26 +950,65 @@ void Compositor::_mergeFrames( const Frames& frames, const bool blendAlpha,
                                void* colorBuffer, void* depthBuffer,
                                const PixelViewport& destPVP )
 {
+    std::vector< FrameImage > images;
+    size_t rowSize = 0;
     for( Frames::const_iterator i = frames.begin(); i != frames.end(); ++i)
     {
         const Frame* frame = *i;
-        const Images& images = frame->getImages();
-        for( Images::const_iterator j = images.begin(); j != images.end(); ++j )
+        const Images& frameImages = frame->getImages();
+        for( Images::const_iterator j = frameImages.begin();
+             j != frameImages.end(); ++j )
         {
             const Image* image = *j;
 
             if( !image->hasPixelData( Frame::BUFFER_COLOR ))
                 continue;
 
+            images.push_back( FrameImage( frame, image ));
+            rowSize = image->getPixelSize( Frame::BUFFER_COLOR );
+        }
+    }
+    if( images.empty( ))
+        return;
+
+    // Fold all images into one horizontal band of the destination at a time,
+    // so that the band stays cache-resident while the sources are streamed
+    // through it. Bands are processed in parallel, the images of each band in
+    // the given order.
+    if( depthBuffer )
+        rowSize += sizeof( uint32_t );
+    rowSize *= destPVP.w;
+#if defined( EQ_USE_PARACOMP_DEPTH ) || defined( EQ_USE_PARACOMP_BLEND )
+    // Paracomp composites whole images only
+    const int32_t bandHeight = destPVP.h;
+#else
+    const int32_t bandHeight = LB_MAX( int32_t( _mergeBandSize / rowSize ), 1 );
+#endif
+    const int32_t nBands = ( destPVP.h + bandHeight - 1 ) / bandHeight;
+    const int32_t nImages = int32_t( images.size( ));
+    LBVERB << "CPU assembly of " << nImages << " images in " << nBands
+           << " bands" << std::endl;
+
+#pragma omp parallel for
+    for( int32_t band = 0; band < nBands; ++band )
+    {
+        const int32_t yBegin = band * bandHeight;
+        const int32_t yEnd = LB_MIN( yBegin + bandHeight, destPVP.h );
+
+        for( int32_t i = 0; i < nImages; ++i )
+        {
+            const Frame* frame = images[i].first;
+            const Image* image = images[i].second;
+
             if( image->hasPixelData( Frame::BUFFER_DEPTH ))
                 _mergeDBImage( colorBuffer, depthBuffer, destPVP,
-                               image, frame->getOffset( ));
+                               image, frame->getOffset(), yBegin, yEnd );
             else if( blendAlpha && image->hasAlpha( ))
                 _mergeBlendImage( colorBuffer, destPVP,
-                                  image, frame->getOffset( ));
+                                  image, frame->getOffset(), yBegin, yEnd );
             else
                 _merge2DImage( colorBuffer, depthBuffer, destPVP,
-                               image, frame->getOffset());
+                               image, frame->getOffset(), yBegin, yEnd );
         }
     }
 }
@@ -786,19 +1016,19 @@ void Compositor::_mergeFrames( const Frames& frames, const bool blendAlpha,
 void Compositor::_mergeDBImage( void* destColor, void* destDepth,
                                 const PixelViewport& destPVP,
                                 const Image* image,
-                                const Vector2i& offset )
+                                const Vector2i& offset,
+                                const int32_t yBegin, const int32_t yEnd )
 {
     LBASSERT( destColor && destDepth );
 
-    LBVERB << "CPU-DB assembly" << std::endl;
-
     uint32_t* destC = reinterpret_cast< uint32_t* >( destColor );
     uint32_t* destD = reinterpret_cast< uint32_t* >( destDepth );
 
     const PixelViewport&  pvp    = image->getPixelViewport();
 
 #ifdef EQ_USE_PARACOMP_DEPTH
-    if( pvp == destPVP && offset == eq::Vector2i::ZERO )
+    if( pvp == destPVP && offset == eq::Vector2i::ZERO &&
+        yBegin == 0 && yEnd == destPVP.h )
     {
         // Use Paracomp to composite
         if( _mergeImage_PC( PC_COMP_DEPTH, destColor, destDepth, image ))
@@ -810,51 +1040,39 @@ void Compositor::_mergeDBImage( void* destColor, void* destDepth,
 
     const int32_t         destX  = offset.x() + pvp.x - destPVP.x;
     const int32_t         destY  = offset.y() + pvp.y - destPVP.y;
+    const int32_t         startY = LB_MAX( yBegin - destY, 0 );
+    const int32_t         endY   = LB_MIN( yEnd - destY, pvp.h );
 
     const uint32_t* color = reinterpret_cast< const uint32_t* >
         ( image->getPixelPointer( Frame::BUFFER_COLOR ));
     const uint32_t* depth = reinterpret_cast< const uint32_t* >
         ( image->getPixelPointer( Frame::BUFFER_DEPTH ));
 
-#pragma omp parallel for
-    for( int32_t y = 0; y < pvp.h; ++y )
+    const detail::MergeDepthRowFunc mergeRow = detail::getMergeDepthRow();
+
+    for( int32_t y = startY; y < endY; ++y )
     {
         const uint32_t skip =  (destY + y) * destPVP.w + destX;
-        uint32_t* destColorIt = destC + skip;
-        uint32_t* destDepthIt = destD + skip;
-        const uint32_t* colorIt = color + y * pvp.w;
-        const uint32_t* depthIt = depth + y * pvp.w;
-
-        for( int32_t x = 0; x < pvp.w; ++x )
-        {
-            if( *destDepthIt > *depthIt )
-            {
-                *destColorIt = *colorIt;
-                *destDepthIt = *depthIt;
-            }
-
-            ++destColorIt;
-            ++destDepthIt;
-            ++colorIt;
-            ++depthIt;
-        }
+        mergeRow( destC + skip, destD + skip, color + y * pvp.w,
+                  depth + y * pvp.w, pvp.w );
     }
 }
 
 void Compositor::_merge2DImage( void* destColor, void* destDepth,
                                 const eq::PixelViewport& destPVP,
                                 const Image* image,
-                                const Vector2i& offset )
+                                const Vector2i& offset,
+                                const int32_t yBegin, const int32_t yEnd )
 {
     // This is mostly copy&paste code from _mergeDBImage :-/
-    LBVERB << "CPU-2D assembly" << std::endl;
-
     uint8_t* destC = reinterpret_cast< uint8_t* >( destColor );
     uint8_t* destD = reinterpret_cast< uint8_t* >( destDepth );
 
     const PixelViewport&  pvp    = image->getPixelViewport();
     const int32_t         destX  = offset.x() + pvp.x - destPVP.x;
     const int32_t         destY  = offset.y() + pvp.y - destPVP.y;
+    const int32_t         startY = LB_MAX( yBegin - destY, 0 );
+    const int32_t         endY   = LB_MIN( yEnd - destY, pvp.h );
 
     LBASSERT( image->hasPixelData( Frame::BUFFER_COLOR ));
 
@@ -862,8 +1080,7 @@ void Compositor::_merge2DImage( void* destColor, void* destDepth,
     const size_t pixelSize = image->getPixelSize( Frame::BUFFER_COLOR );
     const size_t rowLength = pvp.w * pixelSize;
 
-#pragma omp parallel for
-    for( int32_t y = 0; y < pvp.h; ++y )
+    for( int32_t y = startY; y < endY; ++y )
     {
         const size_t skip = ( (destY + y) * destPVP.w + destX ) * pixelSize;
         memcpy( destC + skip, color + y * pvp.w * pixelSize, rowLength);
@@ -876,22 +1093,24 @@ void Compositor::_merge2DImage( void* destColor, void* destDepth,
 
 void Compositor::_mergeBlendImage( void* dest, const eq::PixelViewport& destPVP,
                                    const Image* image,
-                                   const Vector2i& offset )
+                                   const Vector2i& offset,
+                                   const int32_t yBegin, const int32_t yEnd )
 {
-    LBVERB << "CPU-Blend assembly"<< std::endl;
-
     int32_t* destColor = reinterpret_cast< int32_t* >( dest );
 
     const PixelViewport&  pvp    = image->getPixelViewport();
     const int32_t         destX  = offset.x() + pvp.x - destPVP.x;
     const int32_t         destY  = offset.y() + pvp.y - destPVP.y;
+    const int32_t         startY = LB_MAX( yBegin - destY, 0 );
+    const int32_t         endY   = LB_MIN( yEnd - destY, pvp.h );
 
     LBASSERT( image->getPixelSize( Frame::BUFFER_COLOR ) == 4 );
     LBASSERT( image->hasPixelData( Frame::BUFFER_COLOR ));
     LBASSERT( image->hasAlpha( ));
 
 #ifdef EQ_USE_PARACOMP_BLEND
-    if( pvp == destPVP && offset == eq::Vector2i::ZERO )
+    if( pvp == destPVP && offset == eq::Vector2i::ZERO &&
+        yBegin == 0 && yEnd == destPVP.h )
     {
         // Use Paracomp to composite
         if( !_mergeImage_PC( PC_COMP_ALPHA_SORT2_HP, dest, 0, image ))
@@ -915,26 +1134,16 @@ void Compositor::_mergeBlendImage( void* dest, const eq::PixelViewport& destPVP,
     // already have colors as Alpha*Color
 
     int32_t* destColorStart = destColor + destY*destPVP.w + destX;
-    const uint32_t step = sizeof( int32_t );
+    const detail::MergeBlendRowFunc blendRow = detail::getMergeBlendRow();
 
-#pragma omp parallel for
-    for( int32_t y = 0; y < pvp.h; ++y )
+    for( int32_t y = startY; y < endY; ++y )
     {
-        const unsigned char* src =
+        const uint8_t* src =
             reinterpret_cast< const uint8_t* >( color + pvp.w * y );
-        unsigned char*       dst =
+        uint8_t* dst =
             reinterpret_cast< uint8_t* >( destColorStart + destPVP.w * y );
 
-        for( int32_t x = 0; x < pvp.w; ++x )
-        {
-            dst[0] = LB_MIN( src[0] + (src[3]*dst[0] >> 8), 255 );
-            dst[1] = LB_MIN( src[1] + (src[3]*dst[1] >> 8), 255 );
-            dst[2] = LB_MIN( src[2] + (src[3]*dst[2] >> 8), 255 );
-            dst[3] =                   src[3]*dst[3] >> 8;
-
-            src += step;
-            dst += step;
-        }
+        blendRow( dst, src, pvp.w );
     }
 }
 
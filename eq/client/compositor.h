@@ -128,8 +128,12 @@ namespace eq
                                            const bool blendAlpha = false );
 
         /**
-         * Merge the provided frames in the given order into one image in main
-         * memory.
+         * Merge the provided frames into one image in main memory.
+         *
+         * Each frame is merged as soon as it is ready, overlapping the merge
+         * with the arrival of the remaining frames. Alpha-blended frames are
+         * merged in the given order, all other frames in the order they become
+         * available.
          *
          * The returned image does not have to be freed. The compositor
          * maintains one image per thread, that is, the returned image is valid
@@ -271,6 +275,8 @@ namespace eq
       private:
         typedef std::pair< const Frame*, const Image* > FrameImage;
 
+        static Frame* _popReadyFrame( WaitHandle* handle );
+
         static bool _isSubPixelDecomposition( const Frames& frames );
         static const Frames _extractOneSubPixel( Frames& frames );
 
@@ -290,25 +296,40 @@ namespace eq
                                         uint32_t& pixelSize,
                                         uint32_t& externalFormat );
 
+        static const Image* _mergeFramesCPU( const Frames& frames,
+                                             const bool blendAlpha,
+                                             Channel* channel,
+                                             const uint32_t timeout );
+
+        /** Merge one ready frame, growing the result image as needed. */
+        static bool _mergeFrameCPU( Frame* frame, const bool blendAlpha,
+                                    Image* result, PixelViewports& colorOnly );
+
         static void _mergeFrames( const Frames& frames,
                                   const bool blendAlpha,
                                   void* colorBuffer, void* depthBuffer,
                                   const PixelViewport& destPVP );
 
+        /** @name Merge the rows [yBegin, yEnd) of the destination. */
+        //@{
         static void _mergeDBImage( void* destColor, void* destDepth,
                                    const PixelViewport& destPVP,
                                    const Image* image,
-                                   const Vector2i& offset );
+                                   const Vector2i& offset,
+                                   int32_t yBegin, int32_t yEnd );
 
         static void _merge2DImage( void* destColor, void* destDepth,
                                    const PixelViewport& destPVP,
                                    const Image* input,
-                                   const Vector2i& offset );
+                                   const Vector2i& offset,
+                                   int32_t yBegin, int32_t yEnd );
 
         static void _mergeBlendImage( void* dest,
                                       const PixelViewport& destPVP,
                                       const Image* input,
-                                      const Vector2i& offset );
+                                      const Vector2i& offset,
+                                      int32_t yBegin, int32_t yEnd );
+        //@}
         static bool _mergeImage_PC( int operation, void* destColor,
                                     void* destDepth, const Image* source );
         /**
@@ -753,6 +753,7 @@ void Config::addStatistic( const uint32_t originator, const Statistic& stat )
           item.thread = THREAD_ASYNC2;
           // no break;
       case Statistic::CHANNEL_FRAME_WAIT_READY:
+      case Statistic::CHANNEL_TILES:
           type.group = "channel";
           item.layer = 1;
           break;
@@ -762,6 +763,7 @@ void Config::addStatistic( const uint32_t originator, const Statistic& stat )
       case Statistic::CHANNEL_ASSEMBLE:
       case Statistic::CHANNEL_READBACK:
       case Statistic::CHANNEL_VIEW_FINISH:
+      case Statistic::CHANNEL_TILE_WAIT:
           type.group = "channel";
           break;
       case Statistic::CHANNEL_ASYNC_READBACK:
@@ -819,6 +821,7 @@ void Config::addStatistic( const uint32_t originator, const Statistic& stat )
       }
       // no break;
 
+      case Statistic::CHANNEL_TILE:
       case Statistic::WINDOW_FPS:
       case Statistic::NONE:
       case Statistic::ALL:
@@ -843,6 +846,23 @@ void Config::addStatistic( const uint32_t originator, const Statistic& stat )
           item.text = text.str();
           break;
       }
+      case Statistic::CHANNEL_FRAME_TRANSMIT:
+      {
+          std::stringstream text;
+          text << stat.sends << " sends";
+          item.text = text.str();
+          break;
+      }
+      case Statistic::CHANNEL_TILES:
+      {
+          const float time = float( stat.endTime - stat.startTime );
+          std::stringstream text;
+          text << stat.tile << " tiles";
+          if( time > 0.f ) // below the clock resolution otherwise
+              text << ", " << unsigned( 1000.f * stat.tile / time ) << "/s";
+          item.text = text.str();
+          break;
+      }
       default:
           break;
     }
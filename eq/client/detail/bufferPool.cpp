@@ -0,0 +1,158 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bufferPool.h"
+
+#include <lunchbox/scopedMutex.h>
+
+#include <algorithm>
+
+namespace eq
+{
+namespace detail
+{
+namespace
+{
+/** The smallest size class, 2^16 bytes. */
+static const unsigned _minClass = 16;
+
+/** The number of free buffers kept per size class. */
+static const size_t _maxFree = 16;
+
+/** @return the smallest size class holding size bytes. */
+unsigned _getClass( const uint64_t size )
+{
+    unsigned sizeClass = _minClass;
+    while( ( uint64_t( 1 ) << sizeClass ) < size )
+        ++sizeClass;
+    return sizeClass;
+}
+
+/** @return the largest size class fully contained in size bytes. */
+unsigned _getFloorClass( const uint64_t size )
+{
+    unsigned sizeClass = _minClass;
+    while( ( uint64_t( 1 ) << ( sizeClass + 1 )) <= size )
+        ++sizeClass;
+    return sizeClass;
+}
+}
+
+BufferPool& BufferPool::getInstance()
+{
+    static BufferPool pool;
+    return pool;
+}
+
+BufferPool::BufferPool()
+{
+    _stats.hits = 0;
+    _stats.misses = 0;
+    _stats.allocated = 0;
+    _stats.peak = 0;
+}
+
+BufferPool::~BufferPool()
+{
+    for( size_t i = 0; i < _free.size(); ++i )
+        for( size_t j = 0; j < _free[i].size(); ++j )
+            delete _free[i][j];
+}
+
+void BufferPool::resize( lunchbox::Bufferb& buffer, const uint64_t size )
+{
+    if( buffer.getMaxSize() >= size )
+    {
+        buffer.resize( size );
+        return;
+    }
+
+    release( buffer );
+
+    const unsigned sizeClass = _getClass( size );
+    lunchbox::Bufferb* pooled = 0;
+    {
+        lunchbox::ScopedMutex<> mutex( _lock );
+        if( sizeClass < _free.size() && !_free[ sizeClass ].empty( ))
+        {
+            pooled = _free[ sizeClass ].back();
+            _free[ sizeClass ].pop_back();
+            ++_stats.hits;
+        }
+        else
+        {
+            ++_stats.misses;
+            _stats.allocated += uint64_t( 1 ) << sizeClass;
+            _stats.peak = std::max( _stats.peak, _stats.allocated );
+        }
+    }
+
+    if( pooled )
+    {
+        buffer.swap( *pooled );
+        delete pooled;
+    }
+    else
+        buffer.reserve( uint64_t( 1 ) << sizeClass );
+    buffer.resize( size );
+}
+
+void BufferPool::release( lunchbox::Bufferb& buffer )
+{
+    const uint64_t capacity = buffer.getMaxSize();
+    if( capacity == 0 )
+        return;
+
+    if( capacity < ( uint64_t( 1 ) << _minClass ))
+    {
+        buffer.clear(); // not allocated by the pool
+        return;
+    }
+
+    const unsigned sizeClass = _getFloorClass( capacity );
+    lunchbox::ScopedMutex<> mutex( _lock );
+    if( _free.size() <= sizeClass )
+        _free.resize( sizeClass + 1 );
+
+    Buffers& buffers = _free[ sizeClass ];
+    if( buffers.size() >= _maxFree )
+    {
+        _stats.allocated -= std::min( _stats.allocated, capacity );
+        buffer.clear();
+        return;
+    }
+
+    lunchbox::Bufferb* pooled = new lunchbox::Bufferb;
+    pooled->swap( buffer );
+    buffers.push_back( pooled );
+}
+
+BufferPool::Statistics BufferPool::getStatistics() const
+{
+    lunchbox::ScopedMutex<> mutex( _lock );
+    return _stats;
+}
+
+std::ostream& operator << ( std::ostream& os,
+                            const BufferPool::Statistics& stats )
+{
+    return os << "buffer pool " << stats.hits << " hits, " << stats.misses
+              << " misses, " << ( stats.allocated >> 20 ) << " MB allocated, "
+              << ( stats.peak >> 20 ) << " MB peak";
+}
+
+}
+}
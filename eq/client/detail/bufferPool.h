@@ -0,0 +1,86 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_BUFFERPOOL_H
+#define EQ_DETAIL_BUFFERPOOL_H
+
+#include <lunchbox/buffer.h> // used inline
+#include <lunchbox/lock.h> // member
+
+#include <iostream>
+#include <vector>
+
+namespace eq
+{
+namespace detail
+{
+/**
+ * A size-classed pool for the pixel data storage of images.
+ *
+ * Image pixel data sizes change every frame when the viewports are
+ * load-balanced. Instead of reallocating, images exchange their storage with
+ * a pooled buffer of the next power-of-two size class, and return it when
+ * they are recycled. One pool is shared by all images of the process, which
+ * is one node. Thread safe.
+ */
+class BufferPool
+{
+public:
+    /** Pool usage counters. */
+    struct Statistics
+    {
+        uint64_t hits; //!< requests served from the pool
+        uint64_t misses; //!< requests which needed an allocation
+        uint64_t allocated; //!< bytes currently allocated by the pool
+        uint64_t peak; //!< maximum of allocated
+    };
+
+    /** @return the pool of this node. */
+    static BufferPool& getInstance();
+
+    ~BufferPool();
+
+    /**
+     * Resize the buffer to the given size.
+     *
+     * If the buffer is too small, its storage is returned to the pool and
+     * replaced by a pooled buffer of a fitting size class. The content of the
+     * buffer is not preserved in this case.
+     */
+    void resize( lunchbox::Bufferb& buffer, const uint64_t size );
+
+    /** Return the storage of the buffer to the pool, clearing the buffer. */
+    void release( lunchbox::Bufferb& buffer );
+
+    /** @return the current usage counters. */
+    Statistics getStatistics() const;
+
+private:
+    typedef std::vector< lunchbox::Bufferb* > Buffers;
+
+    /** Free buffers, indexed by size class. */
+    std::vector< Buffers > _free;
+    Statistics _stats;
+    mutable lunchbox::Lock _lock;
+
+    BufferPool();
+};
+
+std::ostream& operator << ( std::ostream& os,
+                            const BufferPool::Statistics& stats );
+}
+}
+#endif // EQ_DETAIL_BUFFERPOOL_H
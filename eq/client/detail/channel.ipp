@@ -39,6 +39,9 @@ public:
             : state( STATE_STOPPED )
             , fbo( 0 )
             , initialSize( Vector2i::ZERO )
+            , tileRoundTrip( 0.f )
+            , tileTime( 0.f )
+            , tileBatchSize( 2 )
 #ifdef EQ_USE_SAGE
             , _sageProxy( 0 )
 #endif
@@ -98,6 +101,32 @@ public:
     /** The number of the last finished frame. */
     lunchbox::Monitor< uint32_t > finishedFrame;
 
+    typedef std::map< uint128_t, CompressorSelector > CompressorSelectors;
+    /** Image compressor choice per destination node, transmit thread only */
+    CompressorSelectors compressorSelectors;
+
+    /** Last transmitted images per destination, frame and eye, transmit
+        thread only */
+    ImageDeltas imageDeltas;
+
+    /** Gathers small image payloads for sending, transmit thread only */
+    lunchbox::Bufferb sendStaging;
+
+    /** Finds the foreground of memory images, pipe thread only */
+    ROIFinder roiFinder;
+
+    /** Finds the foreground of async readbacks, transfer thread only */
+    ROIFinder transferROIFinder;
+
+    /** Smoothed time to receive the first tile of a tile task, in ms. */
+    float tileRoundTrip;
+
+    /** Smoothed time to clear, draw and read back one tile, in ms. */
+    float tileTime;
+
+    /** The number of tiles fetched from a tile queue per request. */
+    uint32_t tileBatchSize;
+
 #ifdef EQ_USE_SAGE
     SageProxy* _sageProxy;
 #endif
@@ -0,0 +1,383 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_COMPOSITORKERNELS_H
+#define EQ_DETAIL_COMPOSITORKERNELS_H
+
+// Row kernels for the CPU compositor. Header-only, so that the unit benchmark
+// in tests/compositor can time each implementation individually.
+
+#include <cstddef>
+#include <cstring>
+#ifdef _MSC_VER
+#  include <intrin.h>
+#  include <lunchbox/types.h> // uint32_t et al. on old MSVC
+#else
+#  include <stdint.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#  define EQ_COMPOSITOR_SSE2
+#  include <emmintrin.h>
+#  if defined(__clang__) || ( defined(_MSC_VER) && _MSC_VER >= 1700 ) || \
+      ( defined(__GNUC__) && ( __GNUC__ > 4 ||                          \
+                               ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 )))
+#    define EQ_COMPOSITOR_AVX2
+#    include <immintrin.h>
+#  endif
+#  if !defined(_MSC_VER)
+#    include <cpuid.h>
+#  endif
+#endif
+
+// Function attributes enabling an instruction set for a single kernel, also
+// used by the other kernel headers including this one.
+#if defined(EQ_COMPOSITOR_AVX2) && !defined(_MSC_VER)
+#  define EQ_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define EQ_TARGET_AVX2
+#endif
+#if defined(EQ_COMPOSITOR_SSE2) && !defined(_MSC_VER)
+#  define EQ_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#  define EQ_TARGET_SSE2
+#endif
+
+namespace eq
+{
+namespace detail
+{
+/** The instruction set used by a compositor kernel. */
+enum CompositorKernel
+{
+    KERNEL_SCALAR, //!< Portable C++ implementation, always available
+    KERNEL_SSE2,   //!< 128 bit SSE2 implementation
+    KERNEL_AVX2,   //!< 256 bit AVX2 implementation
+    KERNEL_ALL
+};
+
+/**
+ * Depth-compare and select one row of pixels: a source pixel replaces the
+ * destination pixel if its depth is strictly smaller.
+ */
+typedef void (*MergeDepthRowFunc)( uint32_t* destColor, uint32_t* destDepth,
+                                   const uint32_t* color,
+                                   const uint32_t* depth, size_t nPixels );
+
+/**
+ * Blend one row of premultiplied RGBA8 pixels, as glBlendFuncSeparate(
+ * GL_ONE, GL_SRC_ALPHA, GL_ZERO, GL_SRC_ALPHA ) with 8 bit fixed point math.
+ */
+typedef void (*MergeBlendRowFunc)( uint8_t* dest, const uint8_t* source,
+                                   size_t nPixels );
+
+inline void mergeDepthRow_C( uint32_t* destColor, uint32_t* destDepth,
+                             const uint32_t* color, const uint32_t* depth,
+                             const size_t nPixels )
+{
+    for( size_t i = 0; i < nPixels; ++i )
+    {
+        if( destDepth[i] > depth[i] )
+        {
+            destColor[i] = color[i];
+            destDepth[i] = depth[i];
+        }
+    }
+}
+
+inline void mergeBlendRow_C( uint8_t* dst, const uint8_t* src,
+                             const size_t nPixels )
+{
+    for( size_t i = 0; i < nPixels; ++i )
+    {
+        const unsigned alpha = src[3];
+        const unsigned red   = src[0] + ( alpha * dst[0] >> 8 );
+        const unsigned green = src[1] + ( alpha * dst[1] >> 8 );
+        const unsigned blue  = src[2] + ( alpha * dst[2] >> 8 );
+
+        dst[0] = uint8_t( red   > 255 ? 255 : red );
+        dst[1] = uint8_t( green > 255 ? 255 : green );
+        dst[2] = uint8_t( blue  > 255 ? 255 : blue );
+        dst[3] = uint8_t( alpha * dst[3] >> 8 );
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+#ifdef EQ_COMPOSITOR_SSE2
+EQ_TARGET_SSE2
+inline void mergeDepthRow_SSE2( uint32_t* destColor, uint32_t* destDepth,
+                                const uint32_t* color, const uint32_t* depth,
+                                const size_t nPixels )
+{
+    // SSE2 has no unsigned 32 bit compare: flip the sign bit and use the
+    // signed one.
+    const __m128i bias = _mm_set1_epi32( int( 0x80000000u ));
+    size_t i = 0;
+    for( ; i + 4 <= nPixels; i += 4 )
+    {
+        const __m128i srcD = _mm_loadu_si128( (const __m128i*)( depth + i ));
+        const __m128i dstD = _mm_loadu_si128( (const __m128i*)( destDepth+i ));
+        const __m128i mask = _mm_cmpgt_epi32( _mm_xor_si128( dstD, bias ),
+                                              _mm_xor_si128( srcD, bias ));
+        if( _mm_movemask_epi8( mask ) == 0 )
+            continue;
+
+        const __m128i srcC = _mm_loadu_si128( (const __m128i*)( color + i ));
+        const __m128i dstC = _mm_loadu_si128( (const __m128i*)( destColor+i ));
+        _mm_storeu_si128( (__m128i*)( destColor + i ),
+                          _mm_or_si128( _mm_and_si128( mask, srcC ),
+                                        _mm_andnot_si128( mask, dstC )));
+        _mm_storeu_si128( (__m128i*)( destDepth + i ),
+                          _mm_or_si128( _mm_and_si128( mask, srcD ),
+                                        _mm_andnot_si128( mask, dstD )));
+    }
+    mergeDepthRow_C( destColor + i, destDepth + i, color + i, depth + i,
+                     nPixels - i );
+}
+
+/** Blend two unpacked pixels (8x16 bit lanes). */
+EQ_TARGET_SSE2
+inline __m128i blendPixels_SSE2( const __m128i src, const __m128i dst )
+{
+    __m128i alpha = _mm_shufflelo_epi16( src, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    alpha = _mm_shufflehi_epi16( alpha, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    return _mm_srli_epi16( _mm_mullo_epi16( alpha, dst ), 8 );
+}
+
+EQ_TARGET_SSE2
+inline void mergeBlendRow_SSE2( uint8_t* dst, const uint8_t* src,
+                                const size_t nPixels )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbMask = _mm_set1_epi32( 0x00ffffff );
+    size_t i = 0;
+    for( ; i + 4 <= nPixels; i += 4 )
+    {
+        __m128i* dstIt = (__m128i*)( dst + i * 4 );
+        const __m128i s = _mm_loadu_si128( (const __m128i*)( src + i * 4 ));
+        const __m128i d = _mm_loadu_si128( dstIt );
+
+        const __m128i lo = blendPixels_SSE2( _mm_unpacklo_epi8( s, zero ),
+                                             _mm_unpacklo_epi8( d, zero ));
+        const __m128i hi = blendPixels_SSE2( _mm_unpackhi_epi8( s, zero ),
+                                             _mm_unpackhi_epi8( d, zero ));
+        // alpha*dst >> 8 never exceeds 254: packing is lossless, the color
+        // sum saturates to 255 just as the scalar LB_MIN
+        const __m128i scaled = _mm_packus_epi16( lo, hi );
+        _mm_storeu_si128( dstIt, _mm_adds_epu8( scaled,
+                                                _mm_and_si128( s, rgbMask )));
+    }
+    mergeBlendRow_C( dst + i * 4, src + i * 4, nPixels - i );
+}
+#endif
+
+#ifdef EQ_COMPOSITOR_AVX2
+EQ_TARGET_AVX2
+inline void mergeDepthRow_AVX2( uint32_t* destColor, uint32_t* destDepth,
+                                const uint32_t* color, const uint32_t* depth,
+                                const size_t nPixels )
+{
+    const __m256i bias = _mm256_set1_epi32( int( 0x80000000u ));
+    size_t i = 0;
+    for( ; i + 8 <= nPixels; i += 8 )
+    {
+        const __m256i srcD = _mm256_loadu_si256( (const __m256i*)( depth+i ));
+        const __m256i dstD = _mm256_loadu_si256( (const __m256i*)
+                                                 ( destDepth + i ));
+        const __m256i mask = _mm256_cmpgt_epi32(
+            _mm256_xor_si256( dstD, bias ), _mm256_xor_si256( srcD, bias ));
+        if( _mm256_movemask_epi8( mask ) == 0 )
+            continue;
+
+        const __m256i srcC = _mm256_loadu_si256( (const __m256i*)( color+i ));
+        const __m256i dstC = _mm256_loadu_si256( (const __m256i*)
+                                                 ( destColor + i ));
+        _mm256_storeu_si256( (__m256i*)( destColor + i ),
+                             _mm256_blendv_epi8( dstC, srcC, mask ));
+        _mm256_storeu_si256( (__m256i*)( destDepth + i ),
+                             _mm256_blendv_epi8( dstD, srcD, mask ));
+    }
+    mergeDepthRow_SSE2( destColor + i, destDepth + i, color + i, depth + i,
+                        nPixels - i );
+}
+
+EQ_TARGET_AVX2
+inline __m256i blendPixels_AVX2( const __m256i src, const __m256i dst )
+{
+    __m256i alpha = _mm256_shufflelo_epi16( src, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    alpha = _mm256_shufflehi_epi16( alpha, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    return _mm256_srli_epi16( _mm256_mullo_epi16( alpha, dst ), 8 );
+}
+
+EQ_TARGET_AVX2
+inline void mergeBlendRow_AVX2( uint8_t* dst, const uint8_t* src,
+                                const size_t nPixels )
+{
+    // unpack and pack work per 128 bit lane, so the pixel order is preserved
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rgbMask = _mm256_set1_epi32( 0x00ffffff );
+    size_t i = 0;
+    for( ; i + 8 <= nPixels; i += 8 )
+    {
+        __m256i* dstIt = (__m256i*)( dst + i * 4 );
+        const __m256i s = _mm256_loadu_si256( (const __m256i*)( src + i*4 ));
+        const __m256i d = _mm256_loadu_si256( dstIt );
+
+        const __m256i lo = blendPixels_AVX2( _mm256_unpacklo_epi8( s, zero ),
+                                             _mm256_unpacklo_epi8( d, zero ));
+        const __m256i hi = blendPixels_AVX2( _mm256_unpackhi_epi8( s, zero ),
+                                             _mm256_unpackhi_epi8( d, zero ));
+        const __m256i scaled = _mm256_packus_epi16( lo, hi );
+        _mm256_storeu_si256( dstIt, _mm256_adds_epu8( scaled,
+                                               _mm256_and_si256( s, rgbMask )));
+    }
+    mergeBlendRow_SSE2( dst + i * 4, src + i * 4, nPixels - i );
+}
+#endif
+
+#ifdef EQ_COMPOSITOR_SSE2
+inline void cpuid( const unsigned leaf, unsigned regs[4] )
+{
+#  ifdef _MSC_VER
+    int info[4];
+    __cpuidex( info, int( leaf ), 0 );
+    for( size_t i = 0; i < 4; ++i )
+        regs[i] = unsigned( info[i] );
+#  else
+    __cpuid_count( leaf, 0, regs[0], regs[1], regs[2], regs[3] );
+#  endif
+}
+
+inline bool osSupportsAVX()
+{
+#  ifdef _MSC_VER
+    return ( _xgetbv( 0 ) & 0x6 ) == 0x6;
+#  else
+    unsigned eax, edx;
+    __asm__ __volatile__( "xgetbv" : "=a"(eax), "=d"(edx) : "c"(0) );
+    return ( eax & 0x6 ) == 0x6; // XMM and YMM state saved by the OS
+#  endif
+}
+#endif
+
+/** @return true if the given kernel can run on this CPU. */
+inline bool hasKernel( const CompositorKernel kernel )
+{
+    switch( kernel )
+    {
+      case KERNEL_SCALAR:
+          return true;
+
+#ifdef EQ_COMPOSITOR_SSE2
+      case KERNEL_SSE2:
+      {
+          unsigned regs[4];
+          cpuid( 1, regs );
+          return regs[3] & ( 1u << 26 );
+      }
+#endif
+
+#ifdef EQ_COMPOSITOR_AVX2
+      case KERNEL_AVX2:
+      {
+          unsigned regs[4];
+          cpuid( 0, regs );
+          if( regs[0] < 7 )
+              return false;
+          cpuid( 1, regs );
+          const unsigned osxsave = 1u << 27;
+          const unsigned avx = 1u << 28;
+          if(( regs[2] & ( osxsave | avx )) != ( osxsave | avx ) ||
+             !osSupportsAVX( ))
+          {
+              return false;
+          }
+          cpuid( 7, regs );
+          return regs[1] & ( 1u << 5 );
+      }
+#endif
+
+      default:
+          return false;
+    }
+}
+
+/** @return the fastest kernel available on this CPU. */
+inline CompositorKernel getBestKernel()
+{
+    static const CompositorKernel best = hasKernel( KERNEL_AVX2 ) ?
+        KERNEL_AVX2 : hasKernel( KERNEL_SSE2 ) ? KERNEL_SSE2 : KERNEL_SCALAR;
+    return best;
+}
+
+/** @return the given depth kernel, or 0 if it is not compiled in. */
+inline MergeDepthRowFunc getMergeDepthRow( const CompositorKernel kernel )
+{
+    switch( kernel )
+    {
+      case KERNEL_SCALAR: return mergeDepthRow_C;
+#ifdef EQ_COMPOSITOR_SSE2
+      case KERNEL_SSE2:   return mergeDepthRow_SSE2;
+#endif
+#ifdef EQ_COMPOSITOR_AVX2
+      case KERNEL_AVX2:   return mergeDepthRow_AVX2;
+#endif
+      default:            return 0;
+    }
+}
+
+/** @return the given blend kernel, or 0 if it is not compiled in. */
+inline MergeBlendRowFunc getMergeBlendRow( const CompositorKernel kernel )
+{
+    switch( kernel )
+    {
+      case KERNEL_SCALAR: return mergeBlendRow_C;
+#ifdef EQ_COMPOSITOR_SSE2
+      case KERNEL_SSE2:   return mergeBlendRow_SSE2;
+#endif
+#ifdef EQ_COMPOSITOR_AVX2
+      case KERNEL_AVX2:   return mergeBlendRow_AVX2;
+#endif
+      default:            return 0;
+    }
+}
+
+/** @return the fastest depth kernel for this CPU. */
+inline MergeDepthRowFunc getMergeDepthRow()
+    { return getMergeDepthRow( getBestKernel( )); }
+
+/** @return the fastest blend kernel for this CPU. */
+inline MergeBlendRowFunc getMergeBlendRow()
+    { return getMergeBlendRow( getBestKernel( )); }
+
+/** @return a printable name of the given kernel. */
+inline const char* getKernelName( const CompositorKernel kernel )
+{
+    switch( kernel )
+    {
+      case KERNEL_SCALAR: return "scalar";
+      case KERNEL_SSE2:   return "SSE2";
+      case KERNEL_AVX2:   return "AVX2";
+      default:            return "unknown";
+    }
+}
+}
+}
+
+#endif // EQ_DETAIL_COMPOSITORKERNELS_H
@@ -0,0 +1,229 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "compressorSelector.h"
+
+#include "../image.h"
+
+#include <co/global.h>
+#include <lunchbox/plugin.h>
+#include <lunchbox/pluginRegistry.h>
+#include <lunchbox/pluginVisitor.h>
+#include <lunchbox/plugins/compressor.h>
+
+#include <algorithm>
+
+namespace eq
+{
+namespace detail
+{
+namespace
+{
+/** Weight of a new sample in the running averages. */
+static const float _weight = 0.25f;
+
+/** Re-measure one candidate every n choices. */
+static const uint32_t _probeInterval = 32;
+
+/** Link throughput in MB/ms assumed for links without bandwidth (1 GBit/s) */
+static const float _defaultThroughput = 0.12f;
+
+static const float _megabyte = 1024.f * 1024.f;
+
+class CompressorFinder : public lunchbox::ConstPluginVisitor
+{
+public:
+    CompressorFinder( const uint32_t tokenType, const float minQuality,
+                      const bool ignoreAlpha )
+        : tokenType_( tokenType )
+        , minQuality_( minQuality )
+        , ignoreAlpha_( ignoreAlpha )
+    {}
+
+    virtual ~CompressorFinder() {}
+
+    virtual fabric::VisitorResult visit( const lunchbox::Plugin&,
+                                         const EqCompressorInfo& info )
+    {
+        if( !(info.capabilities & EQ_COMPRESSOR_TRANSFER )           &&
+            info.tokenType == tokenType_                             &&
+            info.quality >= minQuality_                              &&
+            ( ignoreAlpha_ ||
+              !(info.capabilities & EQ_COMPRESSOR_IGNORE_ALPHA )))
+        {
+            result.push_back( info.name );
+        }
+        return fabric::TRAVERSE_CONTINUE;
+    }
+
+    std::vector< uint32_t > result;
+
+private:
+    const uint32_t tokenType_;
+    const float minQuality_;
+    const bool ignoreAlpha_;
+};
+
+float _average( const float oldValue, const float newValue,
+                const uint32_t nSamples )
+{
+    if( nSamples == 0 )
+        return newValue;
+    return oldValue * ( 1.f - _weight ) + newValue * _weight;
+}
+}
+
+CompressorSelector::CompressorSelector()
+    : _throughput( 0.f )
+    , _nChoices( 0 )
+{}
+
+uint32_t CompressorSelector::choose( const Image& image,
+                                     const Frame::Buffer buffer,
+                                     const int64_t bandwidth,
+                                     const bool lossless )
+{
+    const Names& candidates = lossless ?
+        _getCandidates( image.getExternalFormat( buffer ), 1.f, false ) :
+        _getCandidates( image.getExternalFormat( buffer ),
+                        image.getQuality( buffer ), !image.getAlphaUsage( ));
+    if( candidates.empty( ))
+        return EQ_COMPRESSOR_NONE;
+
+    if( _throughput == 0.f )
+        _throughput = bandwidth > 0 ? float( bandwidth ) * 1024.f / 1000.f /
+                                      _megabyte : _defaultThroughput;
+    ++_nChoices;
+
+    // measure each candidate once, then periodically the least recent one
+    uint32_t probe = candidates.front();
+    uint32_t probeUsed = _nChoices;
+    for( Names::const_iterator i = candidates.begin();
+         i != candidates.end(); ++i )
+    {
+        const Sample& sample = _samples[ *i ];
+        if( sample.lastUsed == 0 ) // never tried
+        {
+            probe = *i;
+            break;
+        }
+        if( sample.lastUsed < probeUsed )
+        {
+            probe = *i;
+            probeUsed = sample.lastUsed;
+        }
+    }
+
+    Sample& probeSample = _samples[ probe ];
+    if( probeSample.lastUsed == 0 || _nChoices % _probeInterval == 0 )
+    {
+        probeSample.lastUsed = _nChoices;
+        return probe;
+    }
+
+    const float size = float( image.getPixelDataSize( buffer )) / _megabyte;
+    uint32_t best = EQ_COMPRESSOR_NONE;
+    float bestCost = _getCost( best, size );
+    for( Names::const_iterator i = candidates.begin();
+         i != candidates.end(); ++i )
+    {
+        const float cost = _getCost( *i, size );
+        if( cost < bestCost )
+        {
+            best = *i;
+            bestCost = cost;
+        }
+    }
+
+    if( best != EQ_COMPRESSOR_NONE )
+        _samples[ best ].lastUsed = _nChoices;
+    return best;
+}
+
+bool CompressorSelector::isLossless( const Image& image,
+                                     const Frame::Buffer buffer,
+                                     const uint32_t name )
+{
+    if( name <= EQ_COMPRESSOR_NONE )
+        return true;
+
+    const Names& lossless =
+        _getCandidates( image.getExternalFormat( buffer ), 1.f, false );
+    return std::find( lossless.begin(), lossless.end(), name ) !=
+           lossless.end();
+}
+
+void CompressorSelector::addCompression( const uint32_t name,
+                                         const uint64_t rawSize,
+                                         const uint64_t compressedSize,
+                                         const float time )
+{
+    if( name <= EQ_COMPRESSOR_NONE || rawSize == 0 )
+        return;
+
+    Sample& sample = _samples[ name ];
+    sample.time = _average( sample.time,
+                            time * _megabyte / float( rawSize ),
+                            sample.nSamples );
+    sample.ratio = _average( sample.ratio,
+                             float( compressedSize ) / float( rawSize ),
+                             sample.nSamples );
+    ++sample.nSamples;
+}
+
+void CompressorSelector::addTransmission( const uint64_t size,
+                                          const float time )
+{
+    if( size == 0 || time <= 0.f )
+        return;
+
+    const float throughput = float( size ) / _megabyte / time;
+    _throughput = _average( _throughput, throughput,
+                            _throughput == 0.f ? 0 : 1 );
+}
+
+const CompressorSelector::Names& CompressorSelector::_getCandidates(
+    const uint32_t tokenType, const float minQuality, const bool ignoreAlpha )
+{
+    const uint64_t key = ( uint64_t( tokenType ) << 32 ) |
+                         ( uint64_t( minQuality * 1000.f ) << 1 ) |
+                         ( ignoreAlpha ? 1 : 0 );
+    Candidates::const_iterator i = _candidates.find( key );
+    if( i != _candidates.end( ))
+        return i->second;
+
+    CompressorFinder finder( tokenType, minQuality, ignoreAlpha );
+    co::Global::getPluginRegistry().accept( finder );
+    return _candidates[ key ] = finder.result;
+}
+
+float CompressorSelector::_getCost( const uint32_t name,
+                                    const float size ) const
+{
+    LBASSERT( _throughput > 0.f );
+    if( name == EQ_COMPRESSOR_NONE )
+        return size / _throughput;
+
+    // The receiver decompresses at roughly the speed of the compressor, which
+    // is the only plugin time measurable on the sending side.
+    const Samples::const_iterator i = _samples.find( name );
+    LBASSERT( i != _samples.end( ));
+    const Sample& sample = i->second;
+    return 2.f * size * sample.time + size * sample.ratio / _throughput;
+}
+
+}
+}
@@ -0,0 +1,94 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_COMPRESSORSELECTOR_H
+#define EQ_DETAIL_COMPRESSORSELECTOR_H
+
+#include <eq/client/frame.h> // Frame::Buffer enum
+
+#include <map>
+#include <vector>
+
+namespace eq
+{
+namespace detail
+{
+/**
+ * Chooses the compressor for image transmission to one destination node.
+ *
+ * Keeps running averages of the compression speed and ratio of each candidate
+ * plugin and of the throughput achieved on the link. For each image it picks
+ * the plugin, or no compression, which minimizes the estimated
+ * compress + transmit + decompress time. Unmeasured candidates are tried
+ * first, and the least recently used one is re-measured periodically to
+ * follow changes in image content and link load. Not thread safe, used by the
+ * node's transmit thread.
+ */
+class CompressorSelector
+{
+public:
+    CompressorSelector();
+
+    /**
+     * @return the compressor to use for the given image attachment.
+     * @param image the image to be transmitted.
+     * @param buffer the attachment to compress.
+     * @param bandwidth the nominal link bandwidth in KB/s, used until the
+     *                  throughput has been measured.
+     * @param lossless only consider compressors which reproduce the pixel
+     *                 data exactly, including unused alpha.
+     */
+    uint32_t choose( const Image& image, const Frame::Buffer buffer,
+                     const int64_t bandwidth, const bool lossless );
+
+    /** @return true if the compressor reproduces the pixel data exactly. */
+    bool isLossless( const Image& image, const Frame::Buffer buffer,
+                     const uint32_t name );
+
+    /** Record the compression of size raw bytes with the given plugin. */
+    void addCompression( const uint32_t name, const uint64_t rawSize,
+                         const uint64_t compressedSize, const float time );
+
+    /** Record the transmission of size bytes in time milliseconds. */
+    void addTransmission( const uint64_t size, const float time );
+
+private:
+    struct Sample
+    {
+        Sample() : time( 0.f ), ratio( 1.f ), nSamples( 0 ), lastUsed( 0 ) {}
+
+        float time; //!< compression time in ms per MB
+        float ratio; //!< compressed / raw size
+        uint32_t nSamples;
+        uint32_t lastUsed; //!< choice counter value of the last use
+    };
+    typedef std::map< uint32_t, Sample > Samples;
+    typedef std::vector< uint32_t > Names;
+    typedef std::map< uint64_t, Names > Candidates;
+
+    Samples _samples;
+    Candidates _candidates; //!< compressors per token type and quality
+    float _throughput; //!< link throughput in MB/ms, 0 if unknown
+    uint32_t _nChoices;
+
+    const Names& _getCandidates( const uint32_t tokenType,
+                                 const float minQuality,
+                                 const bool ignoreAlpha );
+    float _getCost( const uint32_t name, const float size ) const;
+};
+}
+}
+#endif // EQ_DETAIL_COMPRESSORSELECTOR_H
@@ -0,0 +1,111 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "imageDelta.h"
+
+#include "../pixelData.h"
+
+#include <lunchbox/plugins/compressor.h>
+#include <cstring>
+
+namespace eq
+{
+namespace detail
+{
+ImageDelta::ImageDelta()
+    : _internalFormat( EQ_COMPRESSOR_DATATYPE_NONE )
+    , _externalFormat( EQ_COMPRESSOR_DATATYPE_NONE )
+    , _pixelSize( 0 )
+    , _nDeltas( 0 )
+{}
+
+bool ImageDelta::encode( const PixelData& data, std::vector< uint64_t >& blocks)
+{
+    blocks.clear();
+    if( !_isCompatible( data ) || _nDeltas >= maxDeltas )
+    {
+        setBase( data );
+        return false;
+    }
+
+    uint8_t* base = _pixels.getData();
+    const uint8_t* pixels = reinterpret_cast< const uint8_t* >( data.pixels );
+    const uint64_t nBlocks = getNumBlocks();
+    for( uint64_t i = 0; i < nBlocks; ++i )
+    {
+        const uint64_t offset = i * blockSize;
+        const uint64_t size = getBlockSize( i, _pixels.getSize( ));
+        if( memcmp( base + offset, pixels + offset, size ) != 0 )
+        {
+            memcpy( base + offset, pixels + offset, size );
+            blocks.push_back( i );
+        }
+    }
+    ++_nDeltas;
+    return true;
+}
+
+void ImageDelta::setBase( const PixelData& data )
+{
+    _internalFormat = data.internalFormat;
+    _externalFormat = data.externalFormat;
+    _pixelSize = data.pixelSize;
+    _pvp = data.pvp;
+    _pixels.replace( data.pixels, _pvp.getArea() * _pixelSize );
+    _nDeltas = 0;
+}
+
+void ImageDelta::clear()
+{
+    _internalFormat = EQ_COMPRESSOR_DATATYPE_NONE;
+    _externalFormat = EQ_COMPRESSOR_DATATYPE_NONE;
+    _pixelSize = 0;
+    _pvp = PixelViewport();
+    _pixels.clear();
+    _nDeltas = 0;
+}
+
+bool ImageDelta::decode( PixelData& data, const uint64_t* blocks,
+                         const uint64_t nBlocks, const uint8_t* payload )
+{
+    if( !_isCompatible( data ))
+        return false;
+
+    uint8_t* base = _pixels.getData();
+    const uint64_t maxBlocks = getNumBlocks();
+    for( uint64_t i = 0; i < nBlocks; ++i )
+    {
+        const uint64_t block = blocks[i];
+        if( block >= maxBlocks )
+            return false;
+
+        const uint64_t size = getBlockSize( block, _pixels.getSize( ));
+        memcpy( base + block * blockSize, payload, size );
+        payload += size;
+    }
+    data.pixels = base;
+    return true;
+}
+
+bool ImageDelta::_isCompatible( const PixelData& data ) const
+{
+    return !_pixels.isEmpty() && data.internalFormat == _internalFormat &&
+           data.externalFormat == _externalFormat &&
+           data.pixelSize == _pixelSize && data.pvp == _pvp;
+}
+
+}
+}
@@ -0,0 +1,138 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_IMAGEDELTA_H
+#define EQ_DETAIL_IMAGEDELTA_H
+
+#include <eq/client/eye.h> // Eye enum
+#include <eq/client/frame.h> // Frame::Buffer enum
+#include <eq/fabric/pixelViewport.h> // member
+
+#include <lunchbox/buffer.h> // member
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace eq
+{
+namespace detail
+{
+/** Encoding of an image attachment in the transmission header. */
+enum DeltaMode
+{
+    DELTA_NONE, //!< full data, not used as a delta base
+    DELTA_BASE, //!< full data, the new base for following deltas
+    DELTA_BLOCKS //!< the changed blocks relative to the base
+};
+
+/**
+ * The last transmitted version of one image attachment.
+ *
+ * The sender keeps a copy of the last image sent to a node, and compares new
+ * pixel data block-wise against it. The receiver keeps the same copy and
+ * patches it with the changed blocks. Both sides update the copy for each
+ * transmission in order, which keeps them in sync. A receiver which lost its
+ * base, e.g., after a failed decode, is not known to the sender, which
+ * therefore periodically sends a full base to resynchronize.
+ */
+class ImageDelta
+{
+public:
+    /** The size of one compared and transmitted block in bytes. */
+    static const uint32_t blockSize = 4096;
+
+    /** The maximum number of deltas encoded between two bases. */
+    static const uint32_t maxDeltas = 32;
+
+    ImageDelta();
+
+    /**
+     * Compare the given pixel data against the base and update the base.
+     *
+     * @param data the uncompressed pixel data.
+     * @param blocks returns the indices of the changed blocks.
+     * @return true if blocks has been computed, false if the data is not
+     *         compatible with the base or a new base is due.
+     */
+    bool encode( const PixelData& data, std::vector< uint64_t >& blocks );
+
+    /** Use the given uncompressed pixel data as the new base. */
+    void setBase( const PixelData& data );
+
+    /** Reset the base, following deltas will fail. */
+    void clear();
+
+    /**
+     * Patch the base with changed blocks.
+     *
+     * @param data the pixel data description, pixels is set to the patched
+     *             base on success.
+     * @param blocks the indices of the changed blocks.
+     * @param nBlocks the number of changed blocks.
+     * @param payload the concatenated content of the changed blocks.
+     * @return true on success, false if the base is not compatible.
+     */
+    bool decode( PixelData& data, const uint64_t* blocks,
+                 const uint64_t nBlocks, const uint8_t* payload );
+
+    /** @return the number of blocks of the base. */
+    uint64_t getNumBlocks() const
+        { return ( _pixels.getSize() + blockSize - 1 ) / blockSize; }
+
+    /** @return the size of a block of pixel data of the given size. */
+    static uint64_t getBlockSize( const uint64_t block, const uint64_t size )
+        { return std::min( uint64_t( blockSize ), size - block * blockSize ); }
+
+private:
+    uint32_t _internalFormat;
+    uint32_t _externalFormat;
+    uint32_t _pixelSize;
+    PixelViewport _pvp;
+    lunchbox::Bufferb _pixels;
+    uint32_t _nDeltas; //!< deltas encoded since the last base
+
+    bool _isCompatible( const PixelData& data ) const;
+};
+
+/**
+ * All image attachment bases of the communication peers.
+ *
+ * An image stream is identified by the peer, the output frame and its eye, so
+ * that the stereo passes and multiple output frames of one channel keep
+ * separate bases.
+ */
+class ImageDeltas
+{
+public:
+    /** @return the delta state of an attachment of an image stream. */
+    ImageDelta& get( const uint128_t& peer, const uint128_t& frameID,
+                     const Eye eye, const uint64_t imageIndex,
+                     const Frame::Buffer buffer )
+    {
+        const uint64_t attachment = ( imageIndex << 16 ) |
+                                    ( uint64_t( eye ) << 8 ) | buffer;
+        return _deltas[ Key( Stream( peer, frameID ), attachment ) ];
+    }
+
+private:
+    typedef std::pair< uint128_t, uint128_t > Stream;
+    typedef std::pair< Stream, uint64_t > Key;
+    std::map< Key, ImageDelta > _deltas;
+};
+}
+}
+#endif // EQ_DETAIL_IMAGEDELTA_H
@@ -0,0 +1,152 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_ROIKERNELS_H
+#define EQ_DETAIL_ROIKERNELS_H
+
+// Row kernels for the CPU region of interest detection on memory images,
+// using the instruction set detection of the compositor kernels.
+
+#include "compositorKernels.h"
+
+namespace eq
+{
+namespace detail
+{
+/** The width and height of one block of the ROI occupancy mask, in pixels. */
+static const size_t roiBlockSize = 16;
+
+/**
+ * Flag the blocks of one row of 32 bit pixels which contain foreground.
+ *
+ * A pixel is background if its masked value equals the masked background.
+ * Blocks already flagged by a previous row are not scanned again.
+ */
+typedef void (*MarkBlocksRowFunc)( uint8_t* blocks, const uint32_t* pixels,
+                                   size_t nPixels, uint32_t mask,
+                                   uint32_t background );
+
+inline void markBlocksRow_C( uint8_t* blocks, const uint32_t* pixels,
+                             const size_t nPixels, const uint32_t mask,
+                             const uint32_t background )
+{
+    for( size_t i = 0; i < nPixels; i += roiBlockSize )
+    {
+        uint8_t& block = blocks[ i / roiBlockSize ];
+        if( block )
+            continue;
+
+        const size_t end = i + roiBlockSize < nPixels ? i + roiBlockSize :
+                                                        nPixels;
+        for( size_t j = i; j < end; ++j )
+        {
+            if(( pixels[j] & mask ) != background )
+            {
+                block = 1;
+                break;
+            }
+        }
+    }
+}
+
+#ifdef EQ_COMPOSITOR_SSE2
+EQ_TARGET_SSE2
+inline void markBlocksRow_SSE2( uint8_t* blocks, const uint32_t* pixels,
+                                const size_t nPixels, const uint32_t mask,
+                                const uint32_t background )
+{
+    // or the differences to the background of all pixels of a block
+    const __m128i m = _mm_set1_epi32( int( mask ));
+    const __m128i bg = _mm_set1_epi32( int( background ));
+    size_t i = 0;
+    for( ; i + roiBlockSize <= nPixels; i += roiBlockSize )
+    {
+        uint8_t& block = blocks[ i / roiBlockSize ];
+        if( block )
+            continue;
+
+        __m128i diff = _mm_setzero_si128();
+        for( size_t j = 0; j < roiBlockSize; j += 4 )
+        {
+            const __m128i p = _mm_loadu_si128( (const __m128i*)
+                                               ( pixels + i + j ));
+            diff = _mm_or_si128( diff,
+                                 _mm_xor_si128( _mm_and_si128( p, m ), bg ));
+        }
+        const __m128i equal = _mm_cmpeq_epi32( diff, _mm_setzero_si128( ));
+        if( _mm_movemask_epi8( equal ) != 0xffff )
+            block = 1;
+    }
+    markBlocksRow_C( blocks + i / roiBlockSize, pixels + i, nPixels - i, mask,
+                     background );
+}
+#endif
+
+#ifdef EQ_COMPOSITOR_AVX2
+EQ_TARGET_AVX2
+inline void markBlocksRow_AVX2( uint8_t* blocks, const uint32_t* pixels,
+                                const size_t nPixels, const uint32_t mask,
+                                const uint32_t background )
+{
+    const __m256i m = _mm256_set1_epi32( int( mask ));
+    const __m256i bg = _mm256_set1_epi32( int( background ));
+    size_t i = 0;
+    for( ; i + roiBlockSize <= nPixels; i += roiBlockSize )
+    {
+        uint8_t& block = blocks[ i / roiBlockSize ];
+        if( block )
+            continue;
+
+        __m256i diff = _mm256_setzero_si256();
+        for( size_t j = 0; j < roiBlockSize; j += 8 )
+        {
+            const __m256i p = _mm256_loadu_si256( (const __m256i*)
+                                                  ( pixels + i + j ));
+            diff = _mm256_or_si256( diff, _mm256_xor_si256(
+                                        _mm256_and_si256( p, m ), bg ));
+        }
+        if( !_mm256_testz_si256( diff, diff ))
+            block = 1;
+    }
+    markBlocksRow_C( blocks + i / roiBlockSize, pixels + i, nPixels - i, mask,
+                     background );
+}
+#endif
+
+/** @return the given ROI kernel, or 0 if it is not compiled in. */
+inline MarkBlocksRowFunc getMarkBlocksRow( const CompositorKernel kernel )
+{
+    switch( kernel )
+    {
+      case KERNEL_SCALAR: return markBlocksRow_C;
+#ifdef EQ_COMPOSITOR_SSE2
+      case KERNEL_SSE2:   return markBlocksRow_SSE2;
+#endif
+#ifdef EQ_COMPOSITOR_AVX2
+      case KERNEL_AVX2:   return markBlocksRow_AVX2;
+#endif
+      default:            return 0;
+    }
+}
+
+/** @return the fastest ROI kernel for this CPU. */
+inline MarkBlocksRowFunc getMarkBlocksRow()
+    { return getMarkBlocksRow( getBestKernel( )); }
+}
+}
+
+#endif // EQ_DETAIL_ROIKERNELS_H
@@ -124,7 +124,15 @@ set(CLIENT_HEADERS
 
 set(CLIENT_SOURCES
   ${SAGE_SOURCES}
+  detail/bufferPool.cpp
+  detail/bufferPool.h
   detail/channel.ipp
+  detail/compositorKernels.h
+  detail/compressorSelector.cpp
+  detail/compressorSelector.h
+  detail/imageDelta.cpp
+  detail/imageDelta.h
+  detail/roiKernels.h
   canvas.cpp
   channel.cpp
   channelStatistics.cpp
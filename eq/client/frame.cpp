@@ -170,6 +170,12 @@ void Frame::useCompressor( const Frame::Buffer buffer, const uint32_t name )
         _impl->frameData->useCompressor( buffer, name );
 }
 
+void Frame::setDeltaTransmission( const bool enabled )
+{
+    if( _impl->frameData )
+        _impl->frameData->setDeltaTransmission( enabled );
+}
+
 void Frame::readback( ObjectManager* glObjects, const DrawableConfig& config )
 {
     LBASSERT( _impl->frameData );
@@ -138,6 +138,13 @@ namespace detail{ class Frame; }
         /** Sets a compressor for compression for following transmissions. */
         EQ_API void useCompressor( const Frame::Buffer buffer,
                                    const uint32_t name );
+
+        /**
+         * Enable the transmission of changed image blocks only.
+         * @sa FrameData::setDeltaTransmission()
+         * @version 1.5.2
+         */
+        EQ_API void setDeltaTransmission( const bool enabled );
         //@}
 
         /** @name Operations */
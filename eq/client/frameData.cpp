@@ -26,6 +26,7 @@
 #include "log.h"
 #include "pixelData.h"
 #include "roiFinder.h"
+#include "detail/imageDelta.h"
 
 #include <eq/fabric/drawableConfig.h>
 #include <eq/util/objectManager.h>
@@ -51,6 +52,7 @@ FrameData::FrameData()
         , _depthQuality( 1.f )
         , _colorCompressor( EQ_COMPRESSOR_AUTO )
         , _depthCompressor( EQ_COMPRESSOR_AUTO )
+        , _deltaTransmission( false )
 {
     _roiFinder = new ROIFinder();
 }
@@ -141,6 +143,10 @@ void FrameData::Data::deserialize( co::DataIStream& is )
 
 void FrameData::clear()
 {
+    // pixel data memory is recycled by size through the buffer pool
+    for( ImagesCIter i = _images.begin(); i != _images.end(); ++i )
+        (*i)->releasePixelData();
+
     _imageCacheLock.set();
     _imageCache.insert( _imageCache.end(), _images.begin(), _images.end( ));
     _imageCacheLock.unset();
@@ -400,7 +406,9 @@ void FrameData::removeListener( lunchbox::Monitor<uint32_t>& listener )
 bool FrameData::addImage( const co::ObjectVersion& frameDataVersion,
                           const PixelViewport& pvp, const Zoom& zoom,
                           const uint32_t buffers_, const bool useAlpha,
-                          uint8_t* data )
+                          uint8_t* data, detail::ImageDeltas& deltas,
+                          const uint128_t& source, const uint128_t& frameID,
+                          const Eye eye, const uint64_t imageIndex )
 {
     Image* image = _allocImage( Frame::TYPE_MEMORY, DrawableConfig(),
                                 false /* set quality */ );
@@ -429,19 +437,47 @@ bool FrameData::addImage( const co::ObjectVersion& frameDataVersion,
             const uint32_t nChunks    = header->nChunks;
             data += sizeof( ImageHeader );
 
-            if( pixelData.isCompressed )
+            if( header->delta == detail::DELTA_BLOCKS )
             {
-                pixelData.compressedSize.resize( nChunks );
-                pixelData.compressedData.resize( nChunks );
+                // changed block indices, followed by the block contents
+                const uint64_t* blocks = reinterpret_cast< uint64_t*>( data );
+                data += nChunks * sizeof( uint64_t );
 
+                detail::ImageDelta& delta =
+                    deltas.get( source, frameID, eye, imageIndex, buffer );
+                if( !delta.decode( pixelData, blocks, nChunks, data ))
+                {
+                    // the sender resends a base after at most maxDeltas
+                    LBWARN << "Can't apply image delta for " << pvp
+                           << ", missing or incompatible base" << std::endl;
+                    delta.clear();
+                    pixelData.pixels = 0; // clears the image
+                }
+                const uint64_t size =
+                    uint64_t( header->pvp.getArea( )) * header->pixelSize;
+                for( uint32_t j = 0; j < nChunks; ++j )
+                    data += detail::ImageDelta::getBlockSize( blocks[j], size );
+            }
+            else if( pixelData.isCompressed )
+            {
+                // the chunk counts of all stripes and all chunk sizes precede
+                // the chunks, which are decompressed in place from the
+                // received command buffer
+                const uint32_t nStripes = header->nStripes;
+                const uint64_t* stripes = reinterpret_cast< uint64_t*>( data );
+                data += nStripes * sizeof( uint64_t );
+                pixelData.compressedStripes.assign( stripes,
+                                                    stripes + nStripes );
+
+                const uint64_t* sizes = reinterpret_cast< uint64_t*>( data );
+                data += nChunks * sizeof( uint64_t );
+
+                pixelData.compressedSize.assign( sizes, sizes + nChunks );
+                pixelData.compressedData.resize( nChunks );
                 for( uint32_t j = 0; j < nChunks; ++j )
                 {
-                    const uint64_t size = *reinterpret_cast< uint64_t*>( data );
-                    data += sizeof( uint64_t );
-
-                    pixelData.compressedSize[j] = size;
                     pixelData.compressedData[j] = data;
-                    data += size;
+                    data += sizes[j];
                 }
             }
             else
@@ -456,6 +492,21 @@ bool FrameData::addImage( const co::ObjectVersion& frameDataVersion,
             image->setZoom( zoom );
             image->setQuality( buffer, header->quality );
             image->setPixelData( buffer, pixelData );
+
+            if( header->delta == detail::DELTA_BASE )
+            {
+                // keep the received data for patching following deltas
+                detail::ImageDelta& delta =
+                    deltas.get( source, frameID, eye, imageIndex, buffer );
+                const PixelData& base = image->getPixelData( buffer );
+                if( base.externalFormat == header->externalFormat &&
+                    base.pixelSize == header->pixelSize )
+                {
+                    delta.setBase( base );
+                }
+                else
+                    delta.clear(); // decompressor changed the format
+            }
         }
     }
 
@@ -19,6 +19,7 @@
 #ifndef EQ_FRAMEDATA_H
 #define EQ_FRAMEDATA_H
 
+#include <eq/client/eye.h>           // Eye enum
 #include <eq/client/frame.h>         // enum Frame::Buffer
 #include <eq/client/types.h>
 
@@ -65,6 +66,8 @@ namespace server { class FrameData; }
             uint32_t                compressorName;
             uint32_t                compressorFlags;
             uint32_t                nChunks;
+            uint32_t                nStripes;
+            uint32_t                delta; //!< detail::DeltaMode
             float                   quality;
         };
 
@@ -185,6 +188,21 @@ namespace server { class FrameData; }
          * @param name the compressor name.
          */
         void useCompressor( const Frame::Buffer buffer, const uint32_t name );
+
+        /**
+         * Enable the transmission of changed image blocks only.
+         *
+         * When enabled, the last image transmitted to each node is kept on
+         * both sides, and following images of the same size and format only
+         * transmit the blocks which have changed. This greatly reduces the
+         * network load for static or slowly changing content.
+         * @version 1.5.2
+         */
+        void setDeltaTransmission( const bool enabled )
+            { _deltaTransmission = enabled; }
+
+        /** @return true if delta transmission is enabled. @version 1.5.2 */
+        bool useDeltaTransmission() const { return _deltaTransmission; }
         //@}
 
         /** @name Operations */
@@ -321,7 +339,9 @@ namespace server { class FrameData; }
         bool addImage( const co::ObjectVersion& frameDataVersion,
                        const PixelViewport& pvp, const Zoom& zoom,
                        const uint32_t buffers, const bool useAlpha,
-                       uint8_t* data );
+                       uint8_t* data, detail::ImageDeltas& deltas,
+                       const uint128_t& source, const uint128_t& frameID,
+                       const Eye eye, const uint64_t imageIndex );
         void setReady( const co::ObjectVersion& frameData,
                        const FrameData::Data& data ); //!< @internal
 
@@ -358,6 +378,8 @@ namespace server { class FrameData; }
         uint32_t _colorCompressor;
         uint32_t _depthCompressor;
 
+        bool _deltaTransmission;
+
         struct Private;
         Private* _private; // placeholder for binary-compatible changes
 
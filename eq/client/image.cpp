@@ -24,6 +24,7 @@
 #include "log.h"
 #include "pixelData.h"
 #include "windowSystem.h"
+#include "detail/bufferPool.h"
 
 #include <eq/util/frameBufferObject.h>
 #include <eq/util/objectManager.h>
@@ -53,6 +54,22 @@ namespace eq
 {
 namespace
 {
+/** Minimum pixel data size for automatic striped compression. */
+static const uint32_t _minStripedSize = 1024 * 1024;
+
+/** Minimum number of rows of one compression stripe. */
+static const int32_t _minStripeRows = 16;
+
+/** @return the rows of the given compression stripe, starting on even rows. */
+PixelViewport _getStripe( const PixelViewport& pvp, const uint32_t stripe,
+                          const uint32_t nStripes )
+{
+    const int32_t begin = int32_t( int64_t( pvp.h ) * stripe / nStripes ) & ~1;
+    const int32_t end = ( stripe + 1 == nStripes ) ? pvp.h :
+                  int32_t( int64_t( pvp.h ) * ( stripe + 1 ) / nStripes ) & ~1;
+    return PixelViewport( pvp.x, pvp.y + begin, pvp.w, end - begin );
+}
+
 /** @internal Raw image data. */
 struct Memory : public PixelData
 {
@@ -63,10 +80,19 @@ public:
     {
         PixelData::reset();
         state = INVALID;
-        localBuffer.clear();
+        detail::BufferPool::getInstance().release( localBuffer );
         hasAlpha = true;
     }
 
+    void releaseLocalBuffer()
+    {
+        if( pixels == localBuffer.getData( ))
+            pixels = 0;
+        state = INVALID;
+        isCompressed = false;
+        detail::BufferPool::getInstance().release( localBuffer );
+    }
+
     void useLocalBuffer()
     {
         LBASSERT( internalFormat != 0 );
@@ -74,7 +100,8 @@ public:
         LBASSERT( pixelSize > 0 );
         LBASSERT( pvp.hasArea( ));
 
-        localBuffer.resize( pvp.getArea() * pixelSize );
+        detail::BufferPool::getInstance().resize( localBuffer,
+                                                  pvp.getArea() * pixelSize );
         pixels = localBuffer.getData();
     }
 
@@ -88,7 +115,8 @@ public:
     State state;   //!< The current state of the memory
 
     /** During the call of setPixelData or writeImage, we have to
-        manage an internal buffer to copy the data */
+        manage an internal buffer to copy the data. Allocated from the
+        node's buffer pool. */
     lunchbox::Bufferb localBuffer;
 
     bool hasAlpha; //!< The uncompressed pixels contain alpha
@@ -117,6 +145,10 @@ struct Attachment
     /** Current pixel data (memory images). */
     Memory memory;
 
+    /** Plugin instances for the compression stripes 1..n. */
+    std::vector< lunchbox::Compressor* > stripeCompressors;
+    std::vector< lunchbox::Decompressor* > stripeDecompressors;
+
     Attachment()
         : active( PLUGIN_FULL )
         , quality( 1.f )
@@ -148,6 +180,118 @@ struct Attachment
         decompressor[ PLUGIN_LOSSY ].clear();
         downloader[ PLUGIN_FULL ].clear();
         downloader[ PLUGIN_LOSSY ].clear();
+
+        for( size_t i = 0; i < stripeCompressors.size(); ++i )
+        {
+            stripeCompressors[i]->clear();
+            delete stripeCompressors[i];
+        }
+        for( size_t i = 0; i < stripeDecompressors.size(); ++i )
+        {
+            stripeDecompressors[i]->clear();
+            delete stripeDecompressors[i];
+        }
+        stripeCompressors.clear();
+        stripeDecompressors.clear();
+    }
+
+    /** @return the compressor of the given stripe, set up for name. */
+    lunchbox::Compressor& getCompressor( const uint32_t stripe,
+                                         const uint32_t name )
+    {
+        if( stripe == 0 )
+            return compressor[ active ];
+
+        while( stripeCompressors.size() < stripe )
+            stripeCompressors.push_back( new lunchbox::Compressor );
+
+        lunchbox::Compressor* plugin = stripeCompressors[ stripe - 1 ];
+        if( !plugin->isGood() || plugin->getInfo().name != name )
+            plugin->setup( co::Global::getPluginRegistry(), name );
+        return *plugin;
+    }
+
+    /** @return the decompressor of the given stripe, set up for name. */
+    lunchbox::Decompressor& getDecompressor( const uint32_t stripe,
+                                             const uint32_t name )
+    {
+        if( stripe == 0 )
+            return decompressor[ PLUGIN_FULL ];
+
+        while( stripeDecompressors.size() < stripe )
+            stripeDecompressors.push_back( new lunchbox::Decompressor );
+
+        lunchbox::Decompressor* plugin = stripeDecompressors[ stripe - 1 ];
+        if( !plugin->isGood() || plugin->getInfo().name != name )
+            plugin->setup( co::Global::getPluginRegistry(), name );
+        return *plugin;
+    }
+
+    /** Compress the memory in nStripes stripes with the active compressor */
+    void compressStripes( const uint32_t nStripes )
+    {
+        const uint32_t name = compressor[ active ].getInfo().name;
+        std::vector< lunchbox::Compressor* > plugins( nStripes );
+        for( uint32_t i = 0; i < nStripes; ++i )
+            plugins[i] = &getCompressor( i, name );
+
+        uint8_t* pixels = reinterpret_cast< uint8_t* >( memory.pixels );
+        const size_t rowSize = memory.pvp.w * memory.pixelSize;
+#pragma omp parallel for
+        for( int32_t i = 0; i < int32_t( nStripes ); ++i )
+        {
+            const PixelViewport pvp = _getStripe( memory.pvp, i, nStripes );
+            uint64_t inDims[4];
+            pvp.convertToPlugin( inDims );
+            plugins[i]->compress( pixels + ( pvp.y - memory.pvp.y ) * rowSize,
+                                  inDims, memory.compressorFlags );
+        }
+
+        memory.compressedSize.clear();
+        memory.compressedData.clear();
+        memory.compressedStripes.resize( nStripes );
+        for( uint32_t i = 0; i < nStripes; ++i )
+        {
+            const unsigned numResults = plugins[i]->getNumResults();
+            memory.compressedStripes[i] = numResults;
+            for( unsigned j = 0; j < numResults ; ++j )
+            {
+                void* data;
+                uint64_t size;
+                plugins[i]->getResult( j, &data, &size );
+                memory.compressedData.push_back( data );
+                memory.compressedSize.push_back( size );
+            }
+        }
+    }
+
+    /** Decompress the given striped pixel data into the memory. */
+    void decompressStripes( const PixelData& pixels )
+    {
+        const uint32_t nStripes = uint32_t( pixels.compressedStripes.size( ));
+        std::vector< lunchbox::Decompressor* > plugins( nStripes );
+        std::vector< size_t > firstBlock( nStripes + 1, 0 );
+        for( uint32_t i = 0; i < nStripes; ++i )
+        {
+            plugins[i] = &getDecompressor( i, pixels.compressorName );
+            firstBlock[ i + 1 ] = firstBlock[i] + pixels.compressedStripes[i];
+        }
+        LBASSERT( firstBlock.back() == pixels.compressedSize.size( ));
+
+        uint8_t* out = reinterpret_cast< uint8_t* >( memory.pixels );
+        const size_t rowSize = memory.pvp.w * memory.pixelSize;
+#pragma omp parallel for
+        for( int32_t i = 0; i < int32_t( nStripes ); ++i )
+        {
+            const PixelViewport pvp = _getStripe( memory.pvp, i, nStripes );
+            uint64_t outDims[4];
+            pvp.convertToPlugin( outDims );
+            plugins[i]->decompress( &pixels.compressedData[ firstBlock[i] ],
+                                    &pixels.compressedSize[ firstBlock[i] ],
+                                    pixels.compressedStripes[i],
+                                    out + ( pvp.y - memory.pvp.y ) * rowSize,
+                                    outDims, pixels.compressorFlags );
+        }
     }
 };
 }
@@ -157,7 +301,8 @@ namespace detail
 class Image
 {
 public:
-    Image() : type( eq::Frame::TYPE_MEMORY ), ignoreAlpha( false ) {}
+    Image() : type( eq::Frame::TYPE_MEMORY ), ignoreAlpha( false )
+            , nStripes( 0 ) {}
 
     /** The rectangle of the current pixel data. */
     PixelViewport pvp;
@@ -174,6 +319,23 @@ public:
     /** Alpha channel significance. */
     bool ignoreAlpha;
 
+    /** Number of compression stripes, 0 for automatic. */
+    uint32_t nStripes;
+
+    /** @return the number of stripes to compress the given memory in. */
+    uint32_t getNumStripes( const Memory& memory ) const
+    {
+        uint32_t n = nStripes;
+        if( n == 0 )
+        {
+            if( memory.pvp.getArea() * memory.pixelSize < _minStripedSize )
+                return 1;
+            n = lunchbox::OMP::getNThreads();
+        }
+        return std::max( 1u, std::min( n, uint32_t( memory.pvp.h /
+                                                    _minStripeRows )));
+    }
+
     Attachment& getAttachment( const eq::Frame::Buffer buffer )
     {
         switch( buffer )
@@ -243,6 +405,12 @@ void Image::flush()
     _impl->depth.flush();
 }
 
+void Image::releasePixelData()
+{
+    _impl->color.memory.releaseLocalBuffer();
+    _impl->depth.memory.releaseLocalBuffer();
+}
+
 void Image::resetPlugins()
 {
     _impl->color.resetPlugins();
@@ -915,6 +1083,12 @@ void Image::setPixelData( const Frame::Buffer buffer, const PixelData& pixels )
     }
     validatePixelData( buffer ); // alloc memory for pixels
 
+    if( pixels.compressedStripes.size() > 1 )
+    {
+        attachment.decompressStripes( pixels );
+        return;
+    }
+
     uint64_t outDims[4];
     memory.pvp.convertToPlugin( outDims );
     const uint64_t nBlocks = pixels.compressedSize.size();
@@ -926,6 +1100,110 @@ void Image::setPixelData( const Frame::Buffer buffer, const PixelData& pixels )
                                          pixels.compressorFlags );
 }
 
+namespace
+{
+/** @return true if the memory holds raw pixels of the full pvp. */
+bool _hasRawPixels( const Memory& memory, const PixelViewport& pvp )
+{
+    return memory.state == Memory::VALID && !memory.isCompressed &&
+           memory.pvp.w == pvp.w && memory.pvp.h == pvp.h;
+}
+
+bool _contains( const PixelViewport& pvp, const PixelViewport& region )
+{
+    PixelViewport clipped( region );
+    clipped.intersect( pvp );
+    return clipped.hasArea() && clipped == region;
+}
+
+/** Copy the rows of a region, may be used in place. */
+void _copyRegion( uint8_t* dst, const uint8_t* src, const PixelViewport& pvp,
+                  const PixelViewport& region, const size_t pixelSize )
+{
+    const size_t rowSize = region.w * pixelSize;
+    const size_t stride = pvp.w * pixelSize;
+    src += ( region.y - pvp.y ) * stride + ( region.x - pvp.x ) * pixelSize;
+
+    for( int32_t y = 0; y < region.h; ++y )
+        ::memmove( dst + y * rowSize, src + y * stride, rowSize );
+}
+}
+
+bool Image::setPixelData( const Image& source, const PixelViewport& region )
+{
+    const PixelViewport& pvp = source.getPixelViewport();
+    if( !_contains( pvp, region ))
+    {
+        LBWARN << "Region " << region << " not in image " << pvp << std::endl;
+        return false;
+    }
+
+    const Frame::Buffer buffers[] = { Frame::BUFFER_COLOR,
+                                      Frame::BUFFER_DEPTH };
+    for( unsigned i = 0; i < 2; ++i )
+    {
+        const Memory& from = source._impl->getMemory( buffers[i] );
+        if( from.state != Memory::INVALID && !_hasRawPixels( from, pvp ))
+            return false;
+    }
+
+    setPixelViewport( region );
+    for( unsigned i = 0; i < 2; ++i )
+    {
+        const Frame::Buffer buffer = buffers[i];
+        const Memory& from = source._impl->getMemory( buffer );
+        if( from.state == Memory::INVALID )
+            continue;
+
+        _setExternalFormat( buffer, from.externalFormat, from.pixelSize,
+                            from.hasAlpha );
+        setInternalFormat( buffer, from.internalFormat );
+
+        Memory& memory = _impl->getMemory( buffer );
+        memory.pvp = PixelViewport( from.pvp.x, from.pvp.y, region.w,
+                                    region.h );
+        validatePixelData( buffer );
+        _copyRegion( reinterpret_cast< uint8_t* >( memory.pixels ),
+                     reinterpret_cast< const uint8_t* >( from.pixels ), pvp,
+                     region, from.pixelSize );
+    }
+    return true;
+}
+
+bool Image::crop( const PixelViewport& region )
+{
+    const PixelViewport pvp = getPixelViewport();
+    if( !_contains( pvp, region ))
+    {
+        LBWARN << "Region " << region << " not in image " << pvp << std::endl;
+        return false;
+    }
+
+    const Frame::Buffer buffers[] = { Frame::BUFFER_COLOR,
+                                      Frame::BUFFER_DEPTH };
+    for( unsigned i = 0; i < 2; ++i )
+    {
+        const Memory& memory = _impl->getMemory( buffers[i] );
+        if( memory.state != Memory::INVALID && !_hasRawPixels( memory, pvp ))
+            return false;
+    }
+
+    for( unsigned i = 0; i < 2; ++i )
+    {
+        Memory& memory = _impl->getMemory( buffers[i] );
+        if( memory.state == Memory::INVALID )
+            continue;
+
+        // the rows move towards the start of the buffer
+        uint8_t* pixels = reinterpret_cast< uint8_t* >( memory.pixels );
+        _copyRegion( pixels, pixels, pvp, region, memory.pixelSize );
+        memory.pvp.w = region.w;
+        memory.pvp.h = region.h;
+    }
+    _impl->pvp = region;
+    return true;
+}
+
 /** Find and activate a compression engine */
 bool Image::allocCompressor( const Frame::Buffer buffer, const uint32_t name )
 {
@@ -1012,6 +1290,7 @@ const PixelData& Image::compressPixelData( const Frame::Buffer buffer )
 
     if( !compressor.isGood() ||
         compressor.getInfo().tokenType != getExternalFormat( buffer ) ||
+        compressor.getInfo().name != memory.compressorName ||
         memory.compressorName == EQ_COMPRESSOR_AUTO )
     {
         if( memory.compressorName == EQ_COMPRESSOR_AUTO )
@@ -1049,6 +1328,15 @@ const PixelData& Image::compressPixelData( const Frame::Buffer buffer )
         memory.compressorFlags |= EQ_COMPRESSOR_IGNORE_ALPHA;
     }
 
+    memory.compressedStripes.clear();
+    const uint32_t nStripes = _impl->getNumStripes( memory );
+    if( nStripes > 1 )
+    {
+        attachment.compressStripes( nStripes );
+        memory.isCompressed = true;
+        return memory;
+    }
+
     uint64_t inDims[4];
     memory.pvp.convertToPlugin( inDims );
     compressor.compress( memory.pixels, inDims, memory.compressorFlags );
@@ -1633,6 +1921,21 @@ bool Image::getAlphaUsage() const
     return !_impl->ignoreAlpha;
 }
 
+void Image::setCompressionStripes( const uint32_t nStripes )
+{
+    if( _impl->nStripes == nStripes )
+        return;
+
+    _impl->nStripes = nStripes;
+    _impl->color.memory.isCompressed = false;
+    _impl->depth.memory.isCompressed = false;
+}
+
+uint32_t Image::getCompressionStripes() const
+{
+    return _impl->nStripes;
+}
+
 void Image::setOffset( int32_t x, int32_t y )
 {
     _impl->pvp.x = x;
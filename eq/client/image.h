@@ -134,6 +134,9 @@ namespace detail { class Image; }
          *
          * The default compressor is EQ_COMPRESSOR_AUTO which selects the most
          * suitable compressor based on the current image and buffer parameters.
+         * During image transmission, EQ_COMPRESSOR_AUTO chooses the compressor,
+         * or no compression, which minimizes the measured compression and
+         * transmission time to the destination node.
          *
          * @param buffer the frame buffer attachment.
          * @param name the compressor name
@@ -155,6 +158,15 @@ namespace detail { class Image; }
         /** Free all cached data of this image. @version 1.0 */
         EQ_API void flush();
 
+        /**
+         * Return the memory of the pixel data to the node's buffer pool.
+         *
+         * Invalidates all pixel data. Used to share memory between recycled
+         * images of different sizes.
+         * @version 1.5.2
+         */
+        EQ_API void releasePixelData();
+
         /**
          * Delete all OpenGL objects allocated from the given object manager.
          *
@@ -237,6 +249,31 @@ namespace detail { class Image; }
         EQ_API void setPixelData( const Frame::Buffer buffer,
                                      const PixelData& data );
 
+        /**
+         * Copy a region of the uncompressed pixel data of another image.
+         *
+         * The region is given in the coordinates of the source image's pixel
+         * viewport, and becomes the pixel viewport of this image.
+         *
+         * @param source the image to copy from.
+         * @param region the part of the source image to copy.
+         * @return true if the pixel data was copied, false if the source has
+         *         no raw pixel data of its full pixel viewport.
+         * @version 1.5.2
+         */
+        EQ_API bool setPixelData( const Image& source,
+                                  const PixelViewport& region );
+
+        /**
+         * Reduce the uncompressed pixel data to a region of this image.
+         *
+         * @param region the part of the pixel viewport to keep.
+         * @return true if the image was cropped, false if it has no raw pixel
+         *         data of its full pixel viewport.
+         * @version 1.5.2
+         */
+        EQ_API bool crop( const PixelViewport& region );
+
         /**
          * Set alpha data preservation during download and compression.
          * @version 1.0
@@ -263,6 +300,21 @@ namespace detail { class Image; }
 
         /** @return the minimum quality. @version 1.0 */
         EQ_API float getQuality( const Frame::Buffer buffer ) const;
+
+        /**
+         * Set the number of horizontal stripes compressed in parallel.
+         *
+         * Each stripe is compressed and decompressed independently by one
+         * thread. The default, 0, uses one stripe per thread for large
+         * images, and 1 compresses the image as a whole.
+         *
+         * @param nStripes the number of stripes, or 0 for automatic.
+         * @version 1.5.2
+         */
+        EQ_API void setCompressionStripes( const uint32_t nStripes );
+
+        /** @return the number of compression stripes. @version 1.5.2 */
+        EQ_API uint32_t getCompressionStripes() const;
         //@}
 
         /** @name Texture Data Access */
@@ -30,6 +30,8 @@
 #include "nodeStatistics.h"
 #include "pipe.h"
 #include "server.h"
+#include "detail/bufferPool.h"
+#include "detail/imageDelta.h"
 
 #include <eq/fabric/commands.h>
 #include <eq/fabric/elementVisitor.h>
@@ -47,6 +49,12 @@ typedef co::CommandFunc<Node> NodeFunc;
 typedef fabric::Node< Config, Node, Pipe, NodeVisitor > Super;
 /** @endcond */
 
+struct Node::Private
+{
+    /** Received image bases for delta transmission, command thread only */
+    detail::ImageDeltas imageDeltas;
+};
+
 
 Node::Node( Config* parent )
         : Super( parent )
@@ -57,6 +65,7 @@ Node::Node( Config* parent )
         , _state( STATE_STOPPED )
         , _finishedFrame( 0 )
         , _unlockedFrame( 0 )
+        , _private( new Private )
 {
 }
 
@@ -65,6 +74,7 @@ Node::Node( Config* parent )
 Node::~Node()
 {
     LBASSERT( getPipes().empty( ));
+    delete _private;
 }
 
 void Node::attach( const UUID& id, const uint32_t instanceID )
@@ -529,6 +539,8 @@ bool Node::_cmdConfigExit( co::ICommand& cmd )
     transmitter.getQueue().push( co::ICommand( )); // wake up to exit
     transmitter.join();
     _flushObjects();
+    LBLOG( LOG_STATS ) << detail::BufferPool::getInstance().getStatistics()
+                       << std::endl;
 
     getConfig()->send( getLocalNode(),
                        fabric::CMD_CONFIG_DESTROY_NODE ) << getID();
@@ -626,6 +638,10 @@ bool Node::_cmdFrameDataTransmit( co::ICommand& cmd )
     const uint32_t buffers = command.get< uint32_t >();
     const uint32_t frameNumber = command.get< uint32_t >();
     const bool useAlpha = command.get< bool >();
+    const uint128_t source = command.get< uint128_t >();
+    const uint128_t frameID = command.get< uint128_t >();
+    const Eye eye = Eye( command.get< uint32_t >( ));
+    const uint64_t imageIndex = command.get< uint64_t >();
     const uint8_t* data = reinterpret_cast< const uint8_t* >(
                 command.getRemainingBuffer( command.getRemainingBufferSize( )));
 
@@ -645,7 +661,9 @@ bool Node::_cmdFrameDataTransmit( co::ICommand& cmd )
     // pointers, we have to go non-const at some point, even though we do not
     // modify the data.
     LBCHECK( frameData->addImage( frameDataVersion, pvp, zoom, buffers,
-                                  useAlpha, const_cast< uint8_t* >( data )));
+                                  useAlpha, const_cast< uint8_t* >( data ),
+                                  _private->imageDeltas, source, frameID, eye,
+                                  imageIndex ));
     return true;
 }
 
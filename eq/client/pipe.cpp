@@ -80,7 +80,16 @@ enum State
 typedef stde::hash_map< uint128_t, Frame* > FrameHash;
 typedef stde::hash_map< uint128_t, FrameDataPtr > FrameDataHash;
 typedef stde::hash_map< uint128_t, View* > ViewHash;
-typedef stde::hash_map< uint128_t, co::QueueSlave* > QueueHash;
+/** A mapped queue slave, its item batch size and its request state. */
+struct QueueData
+{
+    QueueData() : queue( 0 ), batchSize( 0 ), drained( false ) {}
+
+    co::QueueSlave* queue;
+    uint32_t batchSize;
+    bool drained; //!< reported empty, no item requests are outstanding
+};
+typedef stde::hash_map< uint128_t, QueueData > QueueHash;
 typedef FrameHash::const_iterator FrameHashCIter;
 typedef FrameDataHash::const_iterator FrameDataHashCIter;
 typedef ViewHash::const_iterator ViewHashCIter;
@@ -561,23 +570,44 @@ void Pipe::flushFrames( ObjectManager* om )
     _impl->outputFrameDatas.clear();
 }
 
-co::QueueSlave* Pipe::getQueue( const UUID& queueID )
+co::QueueSlave* Pipe::getQueue( const UUID& queueID,
+                                const uint32_t batchSize )
 {
     LB_TS_THREAD( _pipeThread );
     if( queueID == 0 )
         return 0;
 
-    co::QueueSlave* queue = _impl->queues[ queueID ];
-    if( !queue )
+    LBASSERT( batchSize > 0 );
+    QueueData& data = _impl->queues[ queueID ];
+    if( data.queue && ( data.batchSize == batchSize || !data.drained ))
     {
-        queue = new co::QueueSlave;
-        ClientPtr client = getClient();
-        LBCHECK( client->mapObject( queue, queueID ));
+        // A prefetch request may be in flight, whose items would be lost
+        // with the slave. Keep it until it has been drained.
+        data.drained = false;
+        return data.queue;
+    }
 
-        _impl->queues[ queueID ] = queue;
+    ClientPtr client = getClient();
+    if( data.queue )
+    {
+        client->unmapObject( data.queue );
+        delete data.queue;
     }
 
-    return queue;
+    // request the next batch when half of the current batch is left
+    data.queue = new co::QueueSlave( batchSize / 2, batchSize );
+    data.batchSize = batchSize;
+    data.drained = false;
+    LBCHECK( client->mapObject( data.queue, queueID ));
+    return data.queue;
+}
+
+void Pipe::setQueueDrained( const UUID& queueID )
+{
+    LB_TS_THREAD( _pipeThread );
+    QueueHash::iterator i = _impl->queues.find( queueID );
+    if( i != _impl->queues.end( ))
+        i->second.drained = true;
 }
 
 void Pipe::_flushQueues()
@@ -587,7 +617,7 @@ void Pipe::_flushQueues()
 
     for( QueueHashCIter i = _impl->queues.begin(); i !=_impl->queues.end(); ++i)
     {
-        co::QueueSlave* queue = i->second;
+        co::QueueSlave* queue = i->second.queue;
         client->unmapObject( queue );
         delete queue;
     }
@@ -121,8 +121,24 @@ namespace detail { class Pipe; class RenderThread; class ThreadAffinityVisitor;
         Frame* getFrame( const co::ObjectVersion& frameVersion,
                          const Eye eye, const bool output );
 
-        /** @internal @return the queue for the given identifier and version. */
-        co::QueueSlave* getQueue( const UUID& queueID );
+        /**
+         * @internal
+         * @param queueID the identifier of the queue.
+         * @param batchSize the number of items fetched per request.
+         * @return the queue for the given identifier.
+         */
+        co::QueueSlave* getQueue( const UUID& queueID,
+                                  const uint32_t batchSize );
+
+        /**
+         * @internal
+         * Mark a queue as drained after it reported to be empty.
+         *
+         * The empty reply answers the last item request, and all previous
+         * requests have been answered before it. Only drained queues are
+         * replaced to change their batch size.
+         */
+        void setQueueDrained( const UUID& queueID );
 
         /** @internal Clear the frame cache and delete all frames. */
         void flushFrames( ObjectManager* om );
@@ -44,6 +44,7 @@ void PixelData::reset()
     isCompressed = false;
     compressedSize.clear();
     compressedData.clear();
+    compressedStripes.clear();
 }
 
 }
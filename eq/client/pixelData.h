@@ -90,6 +90,15 @@ namespace eq
         /** Sizes of each compressed pixel data block. @version 1.0 */
         std::vector< uint64_t > compressedSize;
 
+        /**
+         * The number of compressed blocks of each horizontal stripe.
+         *
+         * Empty if the pixel data was compressed as a whole.
+         * @sa Image::setCompressionStripes()
+         * @version 1.5.2
+         */
+        std::vector< uint32_t > compressedStripes;
+
         /** The compressor used to produce compressedData. @version 1.0 */
         uint32_t compressorName;
         uint32_t compressorFlags; //!< Flags used for compression. @version 1.0
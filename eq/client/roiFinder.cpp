@@ -32,12 +32,16 @@
 
 #include "gl.h"
 #include "log.h"
+#include "pixelData.h"
+#include "detail/roiKernels.h"
 
 #include <eq/util/frameBufferObject.h>
 #include <eq/util/objectManager.h>
 #include <lunchbox/os.h>
 #include <lunchbox/plugins/compressor.h>
 
+#include <algorithm>
+
 
 namespace eq
 {
@@ -172,10 +176,11 @@ void ROIFinder::_resize( const PixelViewport& pvp )
     {
         _mask.resize( _wbhb );
         _tmpMask.resize( _wbhb );
+    }
 
-        // w * h * sizeof( GL_FLOAT ) * RGBA
+    // w * h * sizeof( GL_FLOAT ) * RGBA
+    if( static_cast<int32_t>(_perBlockInfo.size()) < _wh * 4 )
         _perBlockInfo.resize( _wh * 4 );
-    }
 }
 
 
@@ -763,6 +768,113 @@ for( int i = 0; i < 100; i++ ) {
     return result;
 }
 
+bool ROIFinder::_markBlocks( const Image& image, const Frame::Buffer buffer )
+{
+    if( !image.hasPixelData( buffer ))
+        return false;
+
+    const PixelData& data = image.getPixelData( buffer );
+    const PixelViewport& pvp = image.getPixelViewport();
+    if( data.isCompressed || data.pixelSize != 4 ||
+        data.pvp.w != pvp.w || data.pvp.h != pvp.h )
+    {
+        return false;
+    }
+
+    uint32_t mask = 0xffffffffu;
+    uint32_t background = 0;
+    switch( data.externalFormat )
+    {
+      case EQ_COMPRESSOR_DATATYPE_DEPTH_UNSIGNED_INT:
+          background = 0xffffffffu; // far plane
+          break;
+
+      case EQ_COMPRESSOR_DATATYPE_RGBA:
+      case EQ_COMPRESSOR_DATATYPE_BGRA:
+      {
+          // black, ignoring alpha independent of the byte order
+          const uint8_t rgb[4] = { 0xff, 0xff, 0xff, 0 };
+          memcpy( &mask, rgb, sizeof( mask ));
+          break;
+      }
+
+      default:
+          return false;
+    }
+
+    const detail::MarkBlocksRowFunc markBlocksRow = detail::getMarkBlocksRow();
+    const uint32_t* pixels = reinterpret_cast< const uint32_t* >( data.pixels );
+    Vectorub blocks( _w );
+
+    for( int32_t y = 0; y < _h; y++ )
+    {
+        // skip blocks found by a previous buffer
+        float* info = &_perBlockInfo[ y * _w * 4 ];
+        for( int32_t x = 0; x < _w; x++ )
+            blocks[x] = info[x*4] < 1.0f;
+
+        const int32_t end = LB_MIN( ( y + 1 ) * GRID_SIZE, pvp.h );
+        for( int32_t row = y * GRID_SIZE; row < end; row++ )
+            markBlocksRow( &blocks[0], pixels + size_t( row ) * pvp.w, pvp.w,
+                           mask, background );
+
+        for( int32_t x = 0; x < _w; x++ )
+            if( blocks[x] )
+                info[x*4] = 0.0f;
+    }
+    return true;
+}
+
+PixelViewports ROIFinder::findRegions( const Image& image )
+{
+    const PixelViewport& pvp = image.getPixelViewport();
+    PixelViewports result;
+    result.push_back( pvp );
+
+    if( image.getStorageType() != Frame::TYPE_MEMORY || !pvp.hasArea( ))
+        return result;
+
+    // block counts are limited to eight bit by the area search
+    const PixelViewport blockPVP = _getBoundingPVP(
+        PixelViewport( 0, 0, pvp.w, pvp.h ));
+    if( blockPVP.w > 255 || blockPVP.h > 255 )
+        return result;
+
+    LBASSERT( detail::roiBlockSize == GRID_SIZE );
+    _pvpOriginal = PixelViewport( 0, 0, pvp.w, pvp.h );
+    _resize( blockPVP );
+    std::fill( _perBlockInfo.begin(), _perBlockInfo.begin() + _wh * 4, 1.0f );
+
+    // Depth decides if a pixel was rendered, color adds pixels drawn without
+    // depth test
+    if( !_markBlocks( image, Frame::BUFFER_DEPTH ))
+        return result;
+    if( image.hasPixelData( Frame::BUFFER_COLOR ) &&
+        !_markBlocks( image, Frame::BUFFER_COLOR ))
+    {
+        return result;
+    }
+
+    _init( );
+    _emptyFinder.update( &_mask[0], _wb, _hb );
+    _emptyFinder.setLimits( 200, 0.002f );
+
+    result.clear();
+    _findAreas( result );
+
+    for( size_t i = 0; i < result.size(); ++i )
+    {
+        PixelViewport& region = result[i];
+        region.intersect( _pvpOriginal ); // blocks exceed the image border
+        region.x += pvp.x;
+        region.y += pvp.y;
+    }
+
+    LBLOG( LOG_ASSEMBLY ) << "ROIFinder::findRegions " << pvp << ": "
+                          << result.size() << " areas" << std::endl;
+    return result;
+}
+
 const GLEWContext* ROIFinder::glewGetContext() const
 {
     LBASSERT( _glObjects );
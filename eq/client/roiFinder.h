@@ -37,7 +37,7 @@ namespace eq
     class ROIFinder
     {
     public:
-        ROIFinder();
+        EQ_API ROIFinder();
         virtual ~ROIFinder() {}
 
         /**
@@ -59,6 +59,18 @@ namespace eq
                                     const uint128_t&       frameID,
                                     ObjectManager*         glObjects );
 
+        /**
+         * Finds the areas containing foreground in an image in main memory.
+         *
+         * Pixels are background if their depth is at the far plane and their
+         * color is black. Only images with depth pixel data are analyzed,
+         * other images return their full pixel viewport.
+         *
+         * @param image the image to analyse.
+         * @return Areas for transmission, within the image pixel viewport.
+         */
+        EQ_API PixelViewports findRegions( const Image& image );
+
         /** @return the GL function table, valid during findRegions(). */
         const GLEWContext* glewGetContext() const;
 
@@ -87,6 +99,10 @@ namespace eq
         /** Updates dimensions and resizes arrays */
         void _resize( const PixelViewport& pvp );
 
+        /** Marks blocks of a memory image buffer with foreground in
+            _perBlockInfo, returns false for unsupported pixel formats */
+        bool _markBlocks( const Image& image, const Frame::Buffer buffer );
+
         /** Histogram based based AABB calculation of a region. */
         PixelViewport _getObjectPVP( const PixelViewport& pvp,
                                      const uint8_t* src );
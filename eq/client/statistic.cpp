@@ -61,6 +61,12 @@ static StatisticData _statisticData[] =
    "compress",     Vector3f( 0.f, .7f, 1.f ) },
  { Statistic::CHANNEL_FRAME_WAIT_SENDTOKEN,
    "wait send token", Vector3f( 1.f, 0.f, 0.f ) },
+ { Statistic::CHANNEL_TILE,
+   "tile",         Vector3f( 0.f, .9f, 0.f ) },
+ { Statistic::CHANNEL_TILES,
+   "tiles",        Vector3f( .5f, .5f, 1.f ) },
+ { Statistic::CHANNEL_TILE_WAIT,
+   "wait tiles",   Vector3f( 1.f, 0.f, 0.f ) },
  { Statistic::WINDOW_FINISH,
    "finish",       Vector3f( 1.0f, 1.0f, 0.f ) },
  { Statistic::WINDOW_THROTTLE_FRAMERATE,
@@ -51,6 +51,9 @@ namespace eq
             CHANNEL_FRAME_COMPRESS, //!< Sampling of frame compression
             /** Sampling of waiting for a send token from the receiver */
             CHANNEL_FRAME_WAIT_SENDTOKEN,
+            CHANNEL_TILE, //!< Sampling of a single tile of a tile compound
+            CHANNEL_TILES, //!< Sampling of all tiles of a tile task
+            CHANNEL_TILE_WAIT, //!< Sampling of waiting for tiles from the queue
             WINDOW_FINISH, //!< Sampling of Window::finish before a swap barrier
             /** Sampling of throttling of framerate_equalizer */
             WINDOW_THROTTLE_FRAMERATE,
@@ -70,6 +73,7 @@ namespace eq
         uint32_t frameNumber; //!< The frame during when the sampling happened
         uint32_t task; //!< @internal
         uint32_t plugins[2]; //!< color,depth plugins (readback, compression)
+        uint32_t sends; //!< connection writes (CHANNEL_FRAME_TRANSMIT)
 
         int64_t  startTime; //!< Absolute start time of the operation
         int64_t  endTime;    //!< Absolute end time of the operation
@@ -79,7 +83,8 @@ namespace eq
         float    ratio; //!< compression ratio (transfer, compression)
         float    currentFPS; //!< FPS of last frame (WINDOW_FPS)
         float    averageFPS; //!< Weighted sum averaging of FPS (WINDOW_FPS)
-        float    pad; //!< @internal
+        /** tile index (CHANNEL_TILE), number of tiles (CHANNEL_TILES) */
+        uint32_t tile;
 
         char resourceName[32]; //!< A non-unique name of the originator
 
@@ -108,6 +113,7 @@ template<> inline void byteswap( eq::Statistic& value )
     byteswap( value.task );
     byteswap( value.plugins[0] );
     byteswap( value.plugins[1] );
+    byteswap( value.sends );
 
     byteswap( value.startTime );
     byteswap( value.endTime );
@@ -117,6 +123,7 @@ template<> inline void byteswap( eq::Statistic& value )
     byteswap( value.ratio );
     byteswap( value.currentFPS );
     byteswap( value.averageFPS );
+    byteswap( value.tile );
 }
 }
 
@@ -273,6 +273,7 @@ namespace detail
 class InitVisitor; //!< @internal
 class ExitVisitor; //!< @internal
 class FrameVisitor; //!< @internal
+class ImageDeltas; //!< @internal
 }
 /** @endcond */
 }
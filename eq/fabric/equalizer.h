@@ -55,7 +55,8 @@ namespace detail { class Equalizer; }
             MODE_DB = 0,     //!< Adapt for a sort-last decomposition
             MODE_HORIZONTAL, //!< Adapt for sort-first using horizontal stripes
             MODE_VERTICAL,   //!< Adapt for sort-first using vertical stripes
-            MODE_2D          //!< Adapt for a sort-first decomposition
+            MODE_2D,         //!< Adapt for a sort-first decomposition
+            MODE_HYBRID      //!< Adapt using sort-last and sort-first splits
         };
 
         /** @name Data Access. */
@@ -29,14 +29,16 @@ namespace fabric
     class Tile
     {
     public:
-        Tile() {}
-        Tile( const PixelViewport& pvp_, const Viewport& vp_ )
-                : pvp( pvp_ ), vp( vp_ ) {}
+        Tile() : index( 0 ) {}
+        Tile( const PixelViewport& pvp_, const Viewport& vp_,
+              const uint32_t index_ = 0 )
+                : pvp( pvp_ ), vp( vp_ ), index( index_ ) {}
 
         Frustumf frustum;
         Frustumf ortho;
         PixelViewport pvp;
         Viewport vp;
+        uint32_t index; //!< row-major position in the tile grid
     };
 }
 }
@@ -49,6 +51,7 @@ template<> inline void byteswap( eq::fabric::Tile& tile )
     byteswap( tile.ortho );
     byteswap( tile.pvp );
     byteswap( tile.vp );
+    byteswap( tile.index );
 }
 }
 
@@ -66,7 +66,7 @@ namespace server
          * @name Operations
          */
         //@{
-        void init();
+        EQSERVER_API void init();
         void exit();
 
         /** Schedule deletion of this canvas. */
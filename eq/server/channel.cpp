@@ -88,6 +88,8 @@ Channel::Channel( Window* parent )
         , _segment( 0 )
         , _state( STATE_STOPPED )
         , _lastDrawCompound( 0 )
+        , _taskVisitsDrawCompound( 0 )
+        , _taskVisitsVersion( 0 )
 {
     const Global* global = Global::instance();
     for( unsigned i = 0; i < IATTR_ALL; ++i )
@@ -104,6 +106,8 @@ Channel::Channel( const Channel& from )
         , _segment( 0 )
         , _state( STATE_STOPPED )
         , _lastDrawCompound( 0 )
+        , _taskVisitsDrawCompound( 0 )
+        , _taskVisitsVersion( 0 )
 {
     // Don't copy view and segment. Will be re-set by segment copy ctor
 }
@@ -378,23 +382,49 @@ bool Channel::update( const uint128_t& frameID, const uint32_t frameNumber )
                        << frameNumber << std::endl;
 
     bool updated = false;
-    const Compounds& compounds = getCompounds();
-    for( Compounds::const_iterator i = compounds.begin();
-         i != compounds.end(); ++i )
+    if( _lastDrawCompound )
+    {
+        // Only the compounds using this channel generate tasks. Without a
+        // last draw compound, the draw finish goes with the first compound
+        // of any channel, which needs the full traversal below.
+        _updateTaskVisits();
+        for( std::vector< TaskVisits >::const_iterator i = _taskVisits.begin();
+             i != _taskVisits.end(); ++i )
+        {
+            ChannelUpdateVisitor visitor( this, frameID, frameNumber );
+
+            visitor.setEye( EYE_CYCLOP );
+            _visitTasks( *i, visitor );
+
+            visitor.setEye( EYE_LEFT );
+            _visitTasks( *i, visitor );
+
+            visitor.setEye( EYE_RIGHT );
+            _visitTasks( *i, visitor );
+
+            updated |= visitor.isUpdated();
+        }
+    }
+    else
     {
-        const Compound* compound = *i;
-        ChannelUpdateVisitor visitor( this, frameID, frameNumber );
+        const Compounds& compounds = getCompounds();
+        for( Compounds::const_iterator i = compounds.begin();
+             i != compounds.end(); ++i )
+        {
+            const Compound* compound = *i;
+            ChannelUpdateVisitor visitor( this, frameID, frameNumber );
 
-        visitor.setEye( EYE_CYCLOP );
-        compound->accept( visitor );
+            visitor.setEye( EYE_CYCLOP );
+            compound->accept( visitor );
 
-        visitor.setEye( EYE_LEFT );
-        compound->accept( visitor );
+            visitor.setEye( EYE_LEFT );
+            compound->accept( visitor );
 
-        visitor.setEye( EYE_RIGHT );
-        compound->accept( visitor );
+            visitor.setEye( EYE_RIGHT );
+            compound->accept( visitor );
 
-        updated |= visitor.isUpdated();
+            updated |= visitor.isUpdated();
+        }
     }
 
     send( fabric::CMD_CHANNEL_FRAME_FINISH ) << context << frameNumber;
@@ -405,6 +435,99 @@ bool Channel::update( const uint128_t& frameID, const uint32_t frameNumber )
     return updated;
 }
 
+void Channel::_updateTaskVisits()
+{
+    const uint32_t version = getConfig()->getCompoundsVersion();
+    if( _taskVisitsDrawCompound == _lastDrawCompound &&
+        _taskVisitsVersion == version )
+    {
+        return;
+    }
+
+    _taskVisits.clear();
+    const Compounds& compounds = getCompounds();
+    for( Compounds::const_iterator i = compounds.begin();
+         i != compounds.end(); ++i )
+    {
+        TaskVisits visits;
+        if( _collectTaskVisits( *i, visits ))
+            _taskVisits.push_back( visits );
+    }
+
+    _taskVisitsDrawCompound = _lastDrawCompound;
+    _taskVisitsVersion = version;
+}
+
+bool Channel::_collectTaskVisits( const Compound* compound,
+                                  TaskVisits& visits ) const
+{
+    // The update visitor does nothing for compounds of other channels, but
+    // their parents need to be visited to prune inactive subtrees.
+    const bool used = compound->getChannel() == this ||
+                      compound == _lastDrawCompound;
+    const size_t start = visits.size();
+    TaskVisit visit = { compound, TaskVisit::LEAF, 0 };
+
+    if( compound->isLeaf( ))
+    {
+        if( !used )
+            return false;
+        visit.skip = start + 1;
+        visits.push_back( visit );
+        return true;
+    }
+
+    visit.type = TaskVisit::PRE;
+    visits.push_back( visit );
+
+    bool childUsed = false;
+    const Compounds& children = compound->getChildren();
+    for( Compounds::const_iterator i = children.begin();
+         i != children.end(); ++i )
+    {
+        childUsed |= _collectTaskVisits( *i, visits );
+    }
+
+    if( !used && !childUsed )
+    {
+        visits.resize( start );
+        return false;
+    }
+
+    visit.type = TaskVisit::POST;
+    visits.push_back( visit );
+    visits[ start ].skip = visits.size();
+    return true;
+}
+
+void Channel::_visitTasks( const TaskVisits& visits,
+                           ChannelUpdateVisitor& visitor ) const
+{
+    // Same visit order and pruning as Compound::accept on the full tree
+    size_t i = 0;
+    while( i < visits.size( ))
+    {
+        const TaskVisit& visit = visits[ i ];
+        switch( visit.type )
+        {
+        case TaskVisit::PRE:
+            if( visitor.visitPre( visit.compound ) == TRAVERSE_PRUNE )
+            {
+                i = visit.skip;
+                continue;
+            }
+            break;
+        case TaskVisit::LEAF:
+            visitor.visitLeaf( visit.compound );
+            break;
+        case TaskVisit::POST:
+            visitor.visitPost( visit.compound );
+            break;
+        }
+        ++i;
+    }
+}
+
 co::ObjectOCommand Channel::send( const uint32_t cmd )
 {
     return getNode()->send( cmd, getID( ));
@@ -430,9 +553,9 @@ void Channel::removeListener(  ChannelListener* listener )
         _listeners.erase( i );
 }
 
-void Channel::_fireLoadData( const uint32_t frameNumber,
-                             const Statistics& statistics,
-                             const Viewport& region )
+void Channel::fireLoadData( const uint32_t frameNumber,
+                            const Statistics& statistics,
+                            const Viewport& region )
 {
     LB_TS_SCOPED( _serverThread );
 
@@ -475,7 +598,7 @@ bool Channel::_cmdFrameFinishReply( co::ICommand& cmd )
     const uint32_t frameNumber = command.get< uint32_t >();
     const Statistics statistics = command.get< Statistics >();
 
-    _fireLoadData( frameNumber, statistics, region );
+    fireLoadData( frameNumber, statistics, region );
     return true;
 }
 
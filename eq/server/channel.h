@@ -37,6 +37,7 @@ namespace eq
 namespace server
 {
     class ChannelListener;
+    class ChannelUpdateVisitor;
     class Window;
 
     class Channel : public fabric::Channel< Window, Channel >
@@ -177,6 +178,11 @@ namespace server
         void removeListener( ChannelListener* listener );
         /** @return true if the channel has listeners */
         bool hasListeners() const { return !_listeners.empty(); }
+
+        /** Notify all listeners about the load data of a frame. @internal */
+        EQSERVER_API void fireLoadData( const uint32_t frameNumber,
+                                        const Statistics& statistics,
+                                        const Viewport& region );
         //@}
 
         bool omitOutput() const; //!< @internal
@@ -205,6 +211,26 @@ namespace server
         /** The last draw compound for this entity */
         const Compound* _lastDrawCompound;
 
+        /** A compound visit of the cached task generation traversal. */
+        struct TaskVisit
+        {
+            enum Type { PRE, LEAF, POST };
+
+            const Compound* compound;
+            Type type;
+            size_t skip; //!< index after the matching POST, for pruning
+        };
+        typedef std::vector< TaskVisit > TaskVisits;
+
+        /**
+         * The compounds using this channel and their parents, in traversal
+         * order, one list per root compound. Reused while the compound tree
+         * and the last draw compound are unchanged.
+         */
+        std::vector< TaskVisits > _taskVisits;
+        const Compound* _taskVisitsDrawCompound;
+        uint32_t _taskVisitsVersion;
+
         typedef std::vector< ChannelListener* > ChannelListeners;
         ChannelListeners _listeners;
 
@@ -219,9 +245,11 @@ namespace server
         void _setupRenderContext( const uint128_t& frameID,
                                   RenderContext& context );
 
-        void _fireLoadData( const uint32_t frameNumber,
-                            const Statistics& statistics,
-                            const Viewport& region );
+        void _updateTaskVisits();
+        bool _collectTaskVisits( const Compound* compound,
+                                 TaskVisits& visits ) const;
+        void _visitTasks( const TaskVisits& visits,
+                          ChannelUpdateVisitor& visitor ) const;
 
         /* command handler functions. */
         bool _cmdConfigInitReply( co::ICommand& command );
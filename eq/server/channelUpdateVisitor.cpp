@@ -252,16 +252,20 @@ void ChannelUpdateVisitor::_updateDrawTiles( const Compound* compound,
     {
         const TileQueue* inputQueue = *i;
         const TileQueue* outputQueue = inputQueue->getOutputQueue( context.eye);
-        const UUID& id = outputQueue->getQueueMasterID( context.eye );
-        LBASSERT( id != 0 );
+        const std::vector< UUID > ids =
+            outputQueue->getQueueMasterIDs( context.eye, compound );
+        LBASSERT( !ids.empty( ));
 
         const bool isLocal = (_channel == destChannel);
         const uint32_t tasks = compound->getInheritTasks() &
                             ( eq::fabric::TASK_CLEAR | eq::fabric::TASK_DRAW |
                               eq::fabric::TASK_READBACK );
+        // per-tile times are only collected to order the tiles by cost
+        const bool costOrder =
+            outputQueue->getStrategy() == TileQueue::STRATEGY_COST;
 
         _channel->send( fabric::CMD_CHANNEL_FRAME_TILES )
-                << context << isLocal << id << tasks << frameIDs;
+                << context << isLocal << ids << tasks << frameIDs << costOrder;
         _updated = true;
         LBLOG( LOG_TASKS ) << "TASK tiles " << _channel->getName() <<  " "
                            << std::endl;
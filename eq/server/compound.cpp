@@ -161,6 +161,7 @@ void Compound::_addChild( Compound* child )
 {
     LBASSERT( child->_parent == this );
     _children.push_back( child );
+    getConfig()->setCompoundsDirty();
     _fireChildAdded( child );
 }
 
@@ -172,6 +173,7 @@ bool Compound::_removeChild( Compound* child )
 
     _fireChildRemove( child );
     _children.erase( i );
+    getConfig()->setCompoundsDirty();
     return true;
 }
 
@@ -206,6 +208,7 @@ ServerPtr Compound::getServer()
 void Compound::setChannel( Channel* channel )
 {
     _data.channel = channel;
+    getConfig()->setCompoundsDirty();
 
     // Update swap barrier
     if( !isDestination( ))
@@ -1168,12 +1171,7 @@ void Compound::restore()
 //---------------------------------------------------------------------------
 void Compound::update( const uint32_t frameNumber )
 {
-    // https://github.com/Eyescale/Equalizer/issues/76
-    CompoundUpdateActivateVisitor updateActivateVisitor( frameNumber );
-    accept( updateActivateVisitor );
-
-    CompoundUpdateDataVisitor updateDataVisitor( frameNumber );
-    accept( updateDataVisitor );
+    updateData( frameNumber );
 
     CompoundUpdateOutputVisitor updateOutputVisitor( frameNumber );
     accept( updateOutputVisitor );
@@ -1207,6 +1205,16 @@ void Compound::update( const uint32_t frameNumber )
     }
 }
 
+void Compound::updateData( const uint32_t frameNumber )
+{
+    // https://github.com/Eyescale/Equalizer/issues/76
+    CompoundUpdateActivateVisitor updateActivateVisitor( frameNumber );
+    accept( updateActivateVisitor );
+
+    CompoundUpdateDataVisitor updateDataVisitor( frameNumber );
+    accept( updateDataVisitor );
+}
+
 void Compound::updateInheritData( const uint32_t frameNumber )
 {
     _data.pixel.validate();
@@ -462,7 +462,7 @@ namespace server
         bool isActive() const;
 
         /** Initialize this compound. */
-        void init();
+        EQSERVER_API void init();
 
         /** Exit this compound. */
         void exit();
@@ -489,6 +489,16 @@ namespace server
          */
         void update( const uint32_t frameNumber );
 
+        /**
+         * Updates the activation, inherit data and equalizers of this compound.
+         *
+         * This is the first part of update(). It does not touch any
+         * distributed objects, which allows offline simulations of the
+         * equalizers.
+         * @version 1.5.2
+         */
+        EQSERVER_API void updateData( const uint32_t frameNumber );
+
         /** Update the inherit data of this compound. */
         void updateInheritData( const uint32_t frameNumber );
         //@}
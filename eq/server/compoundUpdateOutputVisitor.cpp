@@ -18,6 +18,7 @@
 
 #include "compoundUpdateOutputVisitor.h"
 
+#include "channel.h"
 #include "config.h"
 #include "frame.h"
 #include "frameData.h"
@@ -25,6 +26,7 @@
 #include "tileQueue.h"
 #include "window.h"
 
+#include "tiles/costStrategy.h"
 #include "tiles/rasterStrategy.h"
 #include "tiles/spiralStrategy.h"
 #include "tiles/squareStrategy.h"
@@ -34,12 +36,56 @@
 #include <eq/fabric/iAttribute.h>
 #include <eq/fabric/tile.h>
 
-#define TILE_STRATEGY ZigzagStrategy
-
 namespace eq
 {
 namespace server
 {
+namespace
+{
+/** Finds the active leaf compounds reading from a given tile queue. */
+class TileConsumerFinder : public CompoundVisitor
+{
+public:
+    TileConsumerFinder( const std::string& name, const fabric::Eye eye )
+        : _name( name ), _eye( eye ) {}
+
+    virtual VisitorResult visitPre( Compound* compound )
+        { return compound->isActive() ? TRAVERSE_CONTINUE : TRAVERSE_PRUNE; }
+
+    virtual VisitorResult visitLeaf( Compound* compound )
+    {
+        // only leaves which will run the tile task pull from the queue
+        if( !compound->isActive() || !compound->isInheritActive( _eye ) ||
+            compound->getInheritTasks() == fabric::TASK_NONE )
+        {
+            return TRAVERSE_CONTINUE;
+        }
+
+        const Channel* channel = compound->getChannel();
+        if( !channel || !channel->isRunning( ))
+            return TRAVERSE_CONTINUE;
+
+        const TileQueues& queues = compound->getInputTileQueues();
+        for( TileQueuesCIter i = queues.begin(); i != queues.end(); ++i )
+        {
+            if( (*i)->getName() == _name )
+            {
+                _consumers.push_back( compound );
+                break;
+            }
+        }
+        return TRAVERSE_CONTINUE;
+    }
+
+    const Compounds& getConsumers() const { return _consumers; }
+
+private:
+    const std::string& _name;
+    const fabric::Eye _eye;
+    Compounds _consumers;
+};
+}
+
 CompoundUpdateOutputVisitor::CompoundUpdateOutputVisitor(
     const uint32_t frameNumber )
         : _frameNumber( frameNumber )
@@ -74,6 +120,8 @@ void CompoundUpdateOutputVisitor::_updateQueues( Compound* compound )
             continue;
         }
 
+        if( queue->isStealing( ))
+            _updateConsumers( queue, compound );
         queue->cycleData( _frameNumber, compound );
 
         //----- Generate tile task commands
@@ -198,14 +246,64 @@ void CompoundUpdateOutputVisitor::_generateTiles( TileQueue* queue,
     std::vector< Vector2i > tiles;
     tiles.reserve( dim.x() * dim.y() );
 
-    tiles::TILE_STRATEGY strategy;
-    strategy( tiles, dim );
-    _addTilesToQueue( queue, compound, tiles );
+    switch( queue->getStrategy( ))
+    {
+      case TileQueue::STRATEGY_RASTER:
+      {
+          tiles::RasterStrategy strategy;
+          strategy( tiles, dim );
+          break;
+      }
+      case TileQueue::STRATEGY_SPIRAL:
+      {
+          tiles::SpiralStrategy strategy;
+          strategy( tiles, dim );
+          break;
+      }
+      case TileQueue::STRATEGY_SQUARE:
+      {
+          tiles::SquareStrategy strategy;
+          strategy( tiles, dim );
+          break;
+      }
+      case TileQueue::STRATEGY_COST:
+      {
+          const size_t nTiles = dim.x() * dim.y();
+          if( queue->getTileCosts().size() != nTiles )
+              queue->resetTileCosts( nTiles );
+
+          tiles::CostStrategy strategy( queue->getTileCosts( ));
+          strategy( tiles, dim );
+          break;
+      }
+      case TileQueue::STRATEGY_ZIGZAG:
+      default:
+      {
+          tiles::ZigzagStrategy strategy;
+          strategy( tiles, dim );
+          break;
+      }
+    }
+    _addTilesToQueue( queue, compound, tiles, dim );
+    queue->distributeTiles();
+}
+
+void CompoundUpdateOutputVisitor::_updateConsumers( TileQueue* queue,
+                                                    Compound* compound )
+{
+    for( fabric::Eye eye = fabric::EYE_CYCLOP; eye < fabric::EYES_ALL;
+         eye = fabric::Eye(eye<<1) )
+    {
+        TileConsumerFinder finder( queue->getName(), eye );
+        compound->accept( finder );
+        queue->setConsumers( eye, finder.getConsumers( ));
+    }
 }
 
 void CompoundUpdateOutputVisitor::_addTilesToQueue( TileQueue* queue,
                                                     Compound* compound,
-                                         const std::vector< Vector2i >& tiles )
+                                         const std::vector< Vector2i >& tiles,
+                                                    const Vector2i& dim )
 {
 
     const Vector2i& tileSize = queue->getTileSize();
@@ -217,6 +315,7 @@ void CompoundUpdateOutputVisitor::_addTilesToQueue( TileQueue* queue,
          i != tiles.end(); ++i )
     {
         const Vector2i& tile = *i;
+        const uint32_t index = tile.y() * dim.x() + tile.x();
         PixelViewport tilePVP( tile.x() * tileSize.x(), tile.y() * tileSize.y(),
                                tileSize.x(), tileSize.y( ));
 
@@ -238,7 +337,7 @@ void CompoundUpdateOutputVisitor::_addTilesToQueue( TileQueue* queue,
                 continue;
             }
 
-            Tile tileItem( tilePVP, tileVP );
+            Tile tileItem( tilePVP, tileVP, index );
             compound->computeTileFrustum( tileItem.frustum, eye, tileItem.vp,
                                           false );
             compound->computeTileFrustum( tileItem.ortho, eye, tileItem.vp,
@@ -58,9 +58,11 @@ namespace server
         void _updateSwapBarriers( Compound* compound );
         void _updateZoom( const Compound* compound, Frame* frame );
 
+        void _updateConsumers( TileQueue* queue, Compound* compound );
         void _generateTiles( TileQueue* queue, Compound* compound );
         void _addTilesToQueue( TileQueue* queue, Compound* compound, 
-                               const std::vector< Vector2i >& tiles );
+                               const std::vector< Vector2i >& tiles,
+                               const Vector2i& dim );
     };
 }
 }
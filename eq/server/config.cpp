@@ -64,6 +64,7 @@ using fabric::OFF;
 
 Config::Config( ServerPtr parent )
         : Super( parent )
+        , _compoundsVersion( 0 )
         , _currentFrame( 0 )
         , _incarnation( 1 )
         , _finishedFrame( 0 )
@@ -401,6 +402,7 @@ void Config::addCompound( Compound* compound )
 {
     LBASSERT( compound->_config == this );
     _compounds.push_back( compound );
+    setCompoundsDirty();
 }
 
 bool Config::removeCompound( Compound* compound )
@@ -411,6 +413,7 @@ bool Config::removeCompound( Compound* compound )
         return false;
 
     _compounds.erase( i );
+    setCompoundsDirty();
     return true;
 }
 
@@ -884,13 +887,24 @@ void Config::_startFrame( const uint128_t& frameID )
     ConfigUpdateDataVisitor configDataVisitor;
     accept( configDataVisitor );
 
+    // Generate the tasks of all nodes in parallel. Each node only touches its
+    // own resources and buffers its commands, which are sent in node order
+    // afterwards to keep the task stream deterministic.
     const Nodes& nodes = getNodes();
+    const ssize_t nNodes = ssize_t( nodes.size( ));
+#pragma omp parallel for if( nNodes > 1 )
+    for( ssize_t i = 0; i < nNodes; ++i )
+        nodes[ i ]->update( frameID, _currentFrame );
+
     co::NodePtr appNode = findApplicationNetNode();
     for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
     {
         Node* node = *i;
-        node->update( frameID, _currentFrame );
-        if( node->isRunning() && node->isApplicationNode( ))
+        if( !node->isRunning( ))
+            continue;
+
+        node->flushSendBuffer();
+        if( node->isApplicationNode( ))
             appNode = 0; // release sent (see below)
     }
 
@@ -85,6 +85,12 @@ namespace server
         /** @return the vector of compounds. */
         const Compounds& getCompounds() const { return _compounds; }
 
+        /** @internal Note a change of the compound tree structure. */
+        void setCompoundsDirty() { ++_compoundsVersion; }
+
+        /** @internal @return the version of the compound tree structure. */
+        uint32_t getCompoundsVersion() const { return _compoundsVersion; }
+
         /**
          * Find the first channel of a given name.
          *
@@ -206,6 +212,9 @@ namespace server
         /** The list of compounds. */
         Compounds _compounds;
 
+        /** Incremented on each change of the compound tree structure. */
+        uint32_t _compoundsVersion;
+
         /** Auto-configured server connections. */
         co::Connections _connections;
 
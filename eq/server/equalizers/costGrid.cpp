@@ -0,0 +1,211 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "costGrid.h"
+
+#include <lunchbox/debug.h>
+
+#include <cmath>
+
+namespace eq
+{
+namespace server
+{
+namespace
+{
+// A higher level factor follows load changes faster, a higher trend factor
+// extrapolates the motion of expensive areas sooner.
+static const float _levelFactor = .5f;
+static const float _trendFactor = .5f;
+}
+
+CostGrid::CostGrid( const size_t width, const size_t height )
+        : _width( 0 )
+        , _height( 0 )
+        , _nFrames( 0 )
+{
+    resize( width, height );
+}
+
+void CostGrid::resize( const size_t width, const size_t height )
+{
+    LBASSERT( width > 0 && height > 0 );
+    if( width == _width && height == _height )
+        return;
+
+    _width = width;
+    _height = height;
+    clear();
+}
+
+void CostGrid::clear()
+{
+    const size_t nCells = _width * _height;
+    _measured.assign( nCells, 0.f );
+    _level.assign( nCells, 0.f );
+    _trend.assign( nCells, 0.f );
+    _sat.assign( ( _width + 1 ) * ( _height + 1 ), 0.f );
+    _nFrames = 0;
+}
+
+void CostGrid::addTime( const fabric::Viewport& area, const float time )
+{
+    fabric::Viewport clipped( area );
+    clipped.intersect( fabric::Viewport::FULL );
+    if( !clipped.hasArea() || time <= 0.f )
+        return;
+
+    const float density = time / clipped.getArea();
+    const float cellW = 1.f / float( _width );
+    const float cellH = 1.f / float( _height );
+    const float xEnd = clipped.getXEnd();
+    const float yEnd = clipped.getYEnd();
+
+    const size_t x0 = size_t( clipped.x * _width );
+    const size_t y0 = size_t( clipped.y * _height );
+    const size_t x1 = LB_MIN( size_t( std::ceil( xEnd * _width )), _width );
+    const size_t y1 = LB_MIN( size_t( std::ceil( yEnd * _height )), _height );
+
+    for( size_t j = y0; j < y1; ++j )
+    {
+        const float h = LB_MIN( float( j + 1 ) * cellH, yEnd ) -
+                        LB_MAX( float( j ) * cellH, clipped.y );
+        if( h <= 0.f )
+            continue;
+
+        for( size_t i = x0; i < x1; ++i )
+        {
+            const float w = LB_MIN( float( i + 1 ) * cellW, xEnd ) -
+                            LB_MAX( float( i ) * cellW, clipped.x );
+            if( w > 0.f )
+                _measured[ j * _width + i ] += density * w * h;
+        }
+    }
+}
+
+void CostGrid::update()
+{
+    const size_t nCells = _measured.size();
+    for( size_t i = 0; i < nCells; ++i )
+    {
+        const float measured = _measured[ i ];
+        _measured[ i ] = 0.f;
+
+        if( _nFrames == 0 )
+        {
+            _level[ i ] = measured;
+            _trend[ i ] = 0.f;
+            continue;
+        }
+
+        const float level = _levelFactor * measured +
+                            ( 1.f - _levelFactor ) * ( _level[i] + _trend[i] );
+        _trend[ i ] = _trendFactor * ( level - _level[ i ] ) +
+                      ( 1.f - _trendFactor ) * _trend[ i ];
+        _level[ i ] = level;
+    }
+    ++_nFrames;
+
+    // summed-area table of the prediction for the next frame
+    const size_t stride = _width + 1;
+    for( size_t j = 0; j < _height; ++j )
+    {
+        float row = 0.f;
+        for( size_t i = 0; i < _width; ++i )
+        {
+            const size_t cell = j * _width + i;
+            row += LB_MAX( _level[ cell ] + _trend[ cell ], 0.f );
+            _sat[ ( j + 1 ) * stride + i + 1 ] = _sat[ j * stride + i + 1 ] +
+                                                 row;
+        }
+    }
+}
+
+float CostGrid::_getIntegral( const float x, const float y ) const
+{
+    // the cost density is constant per cell, which makes the integral
+    // bilinear within each cell
+    const float fx = LB_MIN( LB_MAX( x, 0.f ), 1.f ) * float( _width );
+    const float fy = LB_MIN( LB_MAX( y, 0.f ), 1.f ) * float( _height );
+    const size_t i = LB_MIN( size_t( fx ), _width - 1 );
+    const size_t j = LB_MIN( size_t( fy ), _height - 1 );
+    const float u = fx - float( i );
+    const float v = fy - float( j );
+
+    const size_t stride = _width + 1;
+    const float* row0 = &_sat[ j * stride + i ];
+    const float* row1 = row0 + stride;
+    return ( 1.f - v ) * (( 1.f - u ) * row0[0] + u * row0[1] ) +
+                   v   * (( 1.f - u ) * row1[0] + u * row1[1] );
+}
+
+float CostGrid::getCost( const fabric::Viewport& area ) const
+{
+    const float xEnd = area.getXEnd();
+    const float yEnd = area.getYEnd();
+    return _getIntegral( xEnd, yEnd ) - _getIntegral( area.x, yEnd ) -
+           _getIntegral( xEnd, area.y ) + _getIntegral( area.x, area.y );
+}
+
+float CostGrid::getSplitX( const fabric::Viewport& area,
+                           const float cost ) const
+{
+    return _getSplit( area, cost, true );
+}
+
+float CostGrid::getSplitY( const fabric::Viewport& area,
+                           const float cost ) const
+{
+    return _getSplit( area, cost, false );
+}
+
+float CostGrid::_getSplit( const fabric::Viewport& area, const float cost,
+                           const bool vertical ) const
+{
+    const float start = vertical ? area.x : area.y;
+    const float end = vertical ? area.getXEnd() : area.getYEnd();
+    if( cost <= 0.f )
+        return start;
+
+    // walk the cell boundaries, the cost is linear in between
+    const size_t nCells = vertical ? _width : _height;
+    fabric::Viewport part( area );
+    float pos = start;
+    float partCost = 0.f;
+
+    for( size_t k = size_t( start * nCells ) + 1; ; ++k )
+    {
+        const float next = LB_MIN( float( k ) / float( nCells ), end );
+        if( vertical )
+            part.w = next - start;
+        else
+            part.h = next - start;
+
+        const float nextCost = getCost( part );
+        if( nextCost >= cost )
+            return pos + ( next - pos ) * ( cost - partCost ) /
+                         ( nextCost - partCost );
+        if( next >= end )
+            return end;
+
+        pos = next;
+        partCost = nextCost;
+    }
+}
+
+}
+}
@@ -0,0 +1,102 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQS_COSTGRID_H
+#define EQS_COSTGRID_H
+
+#include "../api.h"
+
+#include <eq/fabric/viewport.h> // used inline
+
+#include <vector>
+
+namespace eq
+{
+namespace server
+{
+    /**
+     * A predictive model of the rendering cost over the normalized unit area.
+     *
+     * The measured times of one frame are distributed evenly over the area
+     * they were measured on. Each finished frame updates a per-cell level and
+     * trend (double exponential smoothing), which smoothes out measurement
+     * noise and extrapolates the cost of moving hot spots by one frame. A
+     * summed-area table of the prediction allows constant-time cost queries
+     * for arbitrary rectangles. A one-dimensional domain, e.g., a DB range,
+     * uses a height of one and the x axis only.
+     *
+     * @version 1.5.2
+     */
+    class CostGrid
+    {
+    public:
+        /** Construct a new cost grid with the given resolution. */
+        EQSERVER_API CostGrid( const size_t width, const size_t height );
+
+        /** Change the resolution, discards all data if it changes. */
+        EQSERVER_API void resize( const size_t width, const size_t height );
+
+        /** Discard all measured and predicted data. */
+        EQSERVER_API void clear();
+
+        /** Add a time measured on the given area to the current frame. */
+        EQSERVER_API void addTime( const fabric::Viewport& area,
+                                   const float time );
+
+        /** Finish the current frame and update the prediction. */
+        EQSERVER_API void update();
+
+        /** @return true if no frame has been finished yet. */
+        bool isEmpty() const { return _nFrames == 0; }
+
+        /** @return the predicted cost of the given area. */
+        EQSERVER_API float getCost( const fabric::Viewport& area ) const;
+
+        /**
+         * @return the position where the predicted cost from the left edge of
+         *         the area reaches the given cost.
+         */
+        EQSERVER_API float getSplitX( const fabric::Viewport& area,
+                                      const float cost ) const;
+
+        /**
+         * @return the position where the predicted cost from the bottom edge
+         *         of the area reaches the given cost.
+         */
+        EQSERVER_API float getSplitY( const fabric::Viewport& area,
+                                      const float cost ) const;
+
+    private:
+        size_t _width;
+        size_t _height;
+        uint32_t _nFrames; //!< number of finished frames
+
+        std::vector< float > _measured; //!< times of the current frame
+        std::vector< float > _level;    //!< smoothed cost per cell
+        std::vector< float > _trend;    //!< smoothed cost change per cell
+        std::vector< float > _sat;      //!< summed-area table of prediction
+
+        /** @return the predicted cost of [0..x]x[0..y] */
+        float _getIntegral( const float x, const float y ) const;
+
+        float _getSplit( const fabric::Viewport& area, const float cost,
+                         const bool vertical ) const;
+    };
+}
+}
+
+#endif // EQS_COSTGRID_H
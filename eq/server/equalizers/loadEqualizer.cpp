@@ -32,12 +32,37 @@ namespace server
 
 std::ostream& operator << ( std::ostream& os, const LoadEqualizer::Node* );
 
+namespace
+{
+// resolution of the screen and range cost grids
+static const size_t _gridCells = 128;
+static const size_t _rangeCells = 1024;
+
+// Hybrid mode removes a DB level when the assembly takes longer than the
+// upper share of the render time per source, and adds one when it takes less
+// than the lower share. The gap avoids flipping between two partitions.
+static const float _maxAssembleShare = .5f;
+static const float _minAssembleShare = .125f;
+
+// DB ranges use the x axis of the cost grid
+Viewport _getArea( const Range& range )
+{
+    return Viewport( range.start, 0.f, range.getSize(), 1.f );
+}
+}
+
 // The tree load balancer organizes the children in a binary tree. At each
 // level, a relative split position is determined by balancing the left subtree
 // against the right subtree.
 
 LoadEqualizer::LoadEqualizer()
         : _tree( 0 )
+        , _costGrid( _gridCells, _gridCells )
+        , _rangeGrid( _rangeCells, 1 )
+        , _costFrame( 0 )
+        , _treeDepth( 0 )
+        , _dbLevels( 0 )
+        , _hybridFrame( 0 )
 {
     LBVERB << "New LoadEqualizer @" << (void*)this << std::endl;
 }
@@ -45,6 +70,12 @@ LoadEqualizer::LoadEqualizer()
 LoadEqualizer::LoadEqualizer( const fabric::Equalizer& from )
         : Equalizer( from )
         , _tree( 0 )
+        , _costGrid( _gridCells, _gridCells )
+        , _rangeGrid( _rangeCells, 1 )
+        , _costFrame( 0 )
+        , _treeDepth( 0 )
+        , _dbLevels( 0 )
+        , _hybridFrame( 0 )
 {}
 
 LoadEqualizer::~LoadEqualizer()
@@ -78,7 +109,9 @@ void LoadEqualizer::notifyUpdatePre( Compound* compound,
               return;
 
           default:
-              _tree = _buildTree( children );
+              _treeDepth = 0; // recomputed by _buildTree
+              _tree = _buildTree( children, 0 );
+              _dbLevels = _treeDepth / 2; // sort-first below the middle level
               break;
         }
     }
@@ -86,17 +119,19 @@ void LoadEqualizer::notifyUpdatePre( Compound* compound,
     // compute new data
     if( getDamping() < 1.f )
     {
-        _history.push_back( LBFrameData( ));
-        _history.back().first = frameNumber;
+        _history.push_back( LBFrameData( frameNumber ));
     }
 
+    _updateHybrid( frameNumber );
     _update( _tree, Viewport(), Range( ));
     _computeSplit();
 }
 
-LoadEqualizer::Node* LoadEqualizer::_buildTree( const Compounds& compounds )
+LoadEqualizer::Node* LoadEqualizer::_buildTree( const Compounds& compounds,
+                                                const uint32_t depth )
 {
     Node* node = new Node;
+    node->depth = depth;
 
     const size_t size = compounds.size();
     if( size == 1 )
@@ -104,6 +139,7 @@ LoadEqualizer::Node* LoadEqualizer::_buildTree( const Compounds& compounds )
         Compound* compound = compounds.front();
 
         node->compound = compound;
+        _treeDepth = LB_MAX( _treeDepth, depth );
 
         Channel* channel = compound->getChannel();
         LBASSERT( channel );
@@ -121,8 +157,8 @@ LoadEqualizer::Node* LoadEqualizer::_buildTree( const Compounds& compounds )
     for( size_t i = middle; i < size; ++i )
         right.push_back( compounds[i] );
 
-    node->left  = _buildTree( left );
-    node->right = _buildTree( right );
+    node->left  = _buildTree( left, depth + 1 );
+    node->right = _buildTree( right, depth + 1 );
 
     return node;
 }
@@ -153,85 +189,86 @@ void LoadEqualizer::notifyLoadData( Channel* channel,
     LBLOG( LOG_LB2 ) << statistics.size()
                      << " samples from "<< channel->getName()
                      << " @ " << frameNumber << std::endl;
-    for( std::deque< LBFrameData >::iterator i = _history.begin();
-         i != _history.end(); ++i )
+
+    // Find corresponding historical data set, at most latency frames old
+    std::deque< LBFrameData >::iterator i = _history.begin();
+    while( i != _history.end() && i->frameNumber != frameNumber )
+        ++i;
+    if( i == _history.end( ))
+        return;
+
+    // Find corresponding historical data item
+    // Note: if the same channel is used twice as a child, the load-compound
+    // association does not work.
+    LBFrameData& frameData = *i;
+    const LBIndex::const_iterator j = frameData.channels.find( channel );
+    if( j == frameData.channels.end( ))
+        return;
+
+    Data& data = frameData.items[ j->second ];
+    const uint32_t taskID = data.taskID;
+    LBASSERTINFO( taskID > 0, channel->getName( ));
+
+    // gather relevant load data
+    int64_t startTime = std::numeric_limits< int64_t >::max();
+    int64_t endTime   = 0;
+    bool    loadSet   = false;
+    int64_t transmitTime = 0;
+    for( size_t k = 0; k < statistics.size(); ++k )
     {
-        LBFrameData& frameData = *i;
-        if( frameData.first != frameNumber )
+        const Statistic& stat = statistics[k];
+        if( stat.task == data.destTaskID )
+            _updateAssembleTime( data, stat );
+
+        // from different compound
+        if( stat.task != taskID || loadSet )
             continue;
 
-        // Found corresponding historical data set
-        LBDatas& items = frameData.second;
-        for( LBDatas::iterator j = items.begin(); j != items.end(); ++j )
+        switch( stat.type )
         {
-            Data& data = *j;
-            if( data.channel != channel )
-                continue;
-
-            // Found corresponding historical data item
-            const uint32_t taskID = data.taskID;
-            LBASSERTINFO( taskID > 0, channel->getName( ));
-
-            // gather relevant load data
-            int64_t startTime = std::numeric_limits< int64_t >::max();
-            int64_t endTime   = 0;
-            bool    loadSet   = false;
-            int64_t transmitTime = 0;
-            for( size_t k = 0; k < statistics.size(); ++k )
-            {
-                const Statistic& stat = statistics[k];
-                if( stat.task == data.destTaskID )
-                    _updateAssembleTime( data, stat );
-
-                // from different compound
-                if( stat.task != taskID || loadSet )
-                    continue;
-
-                switch( stat.type )
-                {
-                case Statistic::CHANNEL_CLEAR:
-                case Statistic::CHANNEL_DRAW:
-                case Statistic::CHANNEL_READBACK:
-                    startTime = LB_MIN( startTime, stat.startTime );
-                    endTime   = LB_MAX( endTime, stat.endTime );
-                    break;
-
-                case Statistic::CHANNEL_ASYNC_READBACK:
-                case Statistic::CHANNEL_FRAME_TRANSMIT:
-                    transmitTime += stat.endTime - stat.startTime;
-                    break;
-                case Statistic::CHANNEL_FRAME_WAIT_SENDTOKEN:
-                    transmitTime -= stat.endTime - stat.startTime;
-                    break;
-
-                // assemble blocks on input frames, stop using subsequent data
-                case Statistic::CHANNEL_ASSEMBLE:
-                    loadSet = true;
-                    break;
-
-                default:
-                    break;
-                }
-            }
+        case Statistic::CHANNEL_CLEAR:
+        case Statistic::CHANNEL_DRAW:
+        case Statistic::CHANNEL_READBACK:
+            startTime = LB_MIN( startTime, stat.startTime );
+            endTime   = LB_MAX( endTime, stat.endTime );
+            break;
 
-            if( startTime == std::numeric_limits< int64_t >::max( ))
-                return;
-
-            data.vp.apply( region ); // Update ROI
-            data.time = endTime - startTime;
-            data.time = LB_MAX( data.time, 1 );
-            data.time = LB_MAX( data.time, transmitTime );
-            data.assembleTime = LB_MAX( data.assembleTime, 0 );
-            LBLOG( LOG_LB2 ) << "Added time " << data.time << " (+"
-                             << data.assembleTime << ") for "
-                             << channel->getName() << " " << data.vp << ", "
-                             << data.range << " @ " << frameNumber << std::endl;
-            return;
-
-            // Note: if the same channel is used twice as a child, the
-            // load-compound association does not work.
+        case Statistic::CHANNEL_ASYNC_READBACK:
+        case Statistic::CHANNEL_FRAME_TRANSMIT:
+            transmitTime += stat.endTime - stat.startTime;
+            break;
+        case Statistic::CHANNEL_FRAME_WAIT_SENDTOKEN:
+            transmitTime -= stat.endTime - stat.startTime;
+            break;
+
+        // assemble blocks on input frames, stop using subsequent data
+        case Statistic::CHANNEL_ASSEMBLE:
+            loadSet = true;
+            break;
+
+        default:
+            break;
         }
     }
+
+    if( startTime == std::numeric_limits< int64_t >::max( ))
+        return;
+
+    if( data.time < 0 )
+    {
+        LBASSERT( frameData.nMissing > 0 );
+        --frameData.nMissing;
+    }
+
+    data.vp.apply( region ); // Update ROI
+    data.time = endTime - startTime;
+    data.time = LB_MAX( data.time, 1 );
+    data.time = LB_MAX( data.time, transmitTime );
+    data.assembleTime = LB_MAX( data.assembleTime, 0 );
+    LBLOG( LOG_LB2 ) << "Added time " << data.time << " (+"
+                     << data.assembleTime << ") for "
+                     << channel->getName() << " " << data.vp << ", "
+                     << data.range << " @ " << frameNumber << std::endl;
 }
 
 void LoadEqualizer::_updateAssembleTime( Data& data, const Statistic& stat )
@@ -259,24 +296,12 @@ void LoadEqualizer::_checkHistory()
          i != _history.rend() && useFrame == 0; ++i )
     {
         const LBFrameData& frameData = *i;
-        const LBDatas& items = frameData.second;
-        bool isComplete = true;
-
-        for( LBDatas::const_iterator j = items.begin();
-             j != items.end() && isComplete; ++j )
-        {
-            const Data& data = *j;
-
-            if( data.time < 0 )
-                isComplete = false;
-        }
-
-        if( isComplete )
-            useFrame = frameData.first;
+        if( frameData.nMissing == 0 )
+            useFrame = frameData.frameNumber;
     }
 
     // 2. delete old, unneeded data sets
-    while( !_history.empty() && _history.front().first < useFrame )
+    while( !_history.empty() && _history.front().frameNumber < useFrame )
         _history.pop_front();
 
     if( _history.empty( )) // insert fake set
@@ -284,9 +309,9 @@ void LoadEqualizer::_checkHistory()
         _history.resize( 1 );
 
         LBFrameData&  frameData  = _history.front();
-        LBDatas& items      = frameData.second;
+        LBDatas& items      = frameData.items;
 
-        frameData.first = 0; // frameNumber
+        LBASSERT( frameData.frameNumber == 0 );
         items.resize( 1 );
 
         Data& data = items.front();
@@ -296,6 +321,46 @@ void LoadEqualizer::_checkHistory()
     }
 }
 
+void LoadEqualizer::_updateHybrid( const uint32_t frameNumber )
+{
+    if( getMode() != MODE_HYBRID || getDamping() >= 1.f )
+        return;
+
+    // only judge frames rendered with the current partition
+    const LBFrameData& frameData = _history.front();
+    if( frameData.frameNumber == 0 || frameData.frameNumber < _hybridFrame )
+        return;
+
+    LBDatas items( frameData.items );
+    _removeEmpty( items );
+    if( items.empty( ))
+        return;
+
+    const float renderTime = float( _getTotalTime( )) / float( items.size( ));
+    const float assembleTime = float( _getAssembleTime( ));
+    uint32_t dbLevels = _dbLevels;
+
+    if( assembleTime > renderTime * _maxAssembleShare )
+    {
+        if( dbLevels > 0 )
+            --dbLevels;
+    }
+    else if( assembleTime < renderTime * _minAssembleShare )
+    {
+        if( dbLevels < _treeDepth )
+            ++dbLevels;
+    }
+
+    if( dbLevels == _dbLevels )
+        return;
+
+    LBLOG( LOG_LB1 ) << "Render time " << renderTime << ", assemble time "
+                     << assembleTime << ": using " << dbLevels << " of "
+                     << _treeDepth << " levels for DB" << std::endl;
+    _dbLevels = dbLevels;
+    _hybridFrame = frameNumber;
+}
+
 float LoadEqualizer::_getTotalResources( ) const
 {
     const Compounds& children = getCompound()->getChildren();
@@ -318,6 +383,9 @@ void LoadEqualizer::_update( Node* node, const Viewport& vp,
         return;
 
     node->mode = getMode();
+    if( node->mode == MODE_HYBRID )
+        node->mode = ( node->depth < _dbLevels ) ? MODE_DB : MODE_2D;
+
     if( node->mode == MODE_2D )
     {
         PixelViewport pvp = getCompound()->getChannel()->getPixelViewport();
@@ -489,7 +557,7 @@ void LoadEqualizer::_updateNode( Node* node, const Viewport& vp,
 int64_t LoadEqualizer::_getTotalTime()
 {
     const LBFrameData& frameData = _history.front();
-    LBDatas items = frameData.second;
+    LBDatas items = frameData.items;
     _removeEmpty( items );
 
     int64_t totalTime = 0;
@@ -507,7 +575,7 @@ int64_t LoadEqualizer::_getAssembleTime( )
         return 0;
 
     const LBFrameData& frameData = _history.front();
-    const LBDatas& items = frameData.second;
+    const LBDatas& items = frameData.items;
 
     int64_t assembleTime = 0;
     for( LBDatas::const_iterator i = items.begin(); i != items.end(); ++i )
@@ -526,44 +594,44 @@ void LoadEqualizer::_computeSplit()
     const LBFrameData& frameData = _history.front();
     const Compound* compound = getCompound();
     LBLOG( LOG_LB2 ) << "----- balance " << compound->getChannel()->getName()
-                    << " using frame " << frameData.first << " tree "
+                    << " using frame " << frameData.frameNumber << " tree "
                      << std::endl << _tree;
 
-    // sort load items for each of the split directions
-    LBDatas items( frameData.second );
-    _removeEmpty( items );
+    _updateCostGrid();
 
-    LBDatas sortedData[3] = { items, items, items };
+    LBLOG( LOG_LB2 ) << "Render time " << _getTotalTime() << " for "
+                     << _tree->resources << " resources" << std::endl;
+    if( _tree->resources > 0.f )
+        _computeSplit( _tree, Viewport(), Range( ));
+}
 
-    if( getMode() == MODE_DB )
-    {
-        LBDatas& rangeData = sortedData[ MODE_DB ];
-        sort( rangeData.begin(), rangeData.end(), _compareRange );
-    }
-    else
-    {
-        LBDatas& xData = sortedData[ MODE_VERTICAL ];
-        sort( xData.begin(), xData.end(), _compareX );
+void LoadEqualizer::_updateCostGrid()
+{
+    // learn each complete frame once, the initial fake set only if empty
+    const LBFrameData& frameData = _history.front();
+    if( !_costGrid.isEmpty() && frameData.frameNumber <= _costFrame )
+        return;
 
-        LBDatas& yData = sortedData[ MODE_HORIZONTAL ];
-        sort( yData.begin(), yData.end(), _compareY );
+    LBDatas items( frameData.items );
+    _removeEmpty( items );
 
-#ifndef NDEBUG
-        for( LBDatas::const_iterator i = xData.begin(); i != xData.end();
-             ++i )
-        {
-            const Data& data = *i;
-            LBLOG( LOG_LB2 ) << "  " << data.vp << ", time " << data.time
-                             << " (+" << data.assembleTime << ")" << std::endl;
-        }
-#endif
+    for( LBDatas::const_iterator i = items.begin(); i != items.end(); ++i )
+    {
+        const Data& data = *i;
+        LBLOG( LOG_LB2 ) << "  " << data.vp << ", " << data.range << " time "
+                         << data.time << " (+" << data.assembleTime << ")"
+                         << std::endl;
+
+        // The cost is modeled separable in screen and range space. Each grid
+        // accumulates the total over the other domain, which cancels when
+        // splitting by cost ratios in hybrid mode.
+        _costGrid.addTime( data.vp, float( data.time ));
+        _rangeGrid.addTime( _getArea( data.range ), float( data.time ));
     }
 
-    const float time = float( _getTotalTime( ));
-    LBLOG( LOG_LB2 ) << "Render time " << time << " for "
-                     << _tree->resources << " resources" << std::endl;
-    if( _tree->resources > 0.f )
-        _computeSplit( _tree, time, sortedData, Viewport(), Range( ));
+    _costGrid.update();
+    _rangeGrid.update();
+    _costFrame = frameData.frameNumber;
 }
 
 void LoadEqualizer::_removeEmpty( LBDatas& items )
@@ -579,12 +647,9 @@ void LoadEqualizer::_removeEmpty( LBDatas& items )
     }
 }
 
-void LoadEqualizer::_computeSplit( Node* node, const float time,
-                                   LBDatas* datas, const Viewport& vp,
+void LoadEqualizer::_computeSplit( Node* node, const Viewport& vp,
                                    const Range& range )
 {
-    LBLOG( LOG_LB2 ) << "_computeSplit " << vp << ", " << range << " time "
-                    << time << std::endl;
     LBASSERTINFO( vp.isValid(), vp );
     LBASSERTINFO( range.isValid(), range );
     LBASSERTINFO( node->resources > 0.f || !vp.hasArea() || !range.hasData(),
@@ -600,119 +665,30 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
 
     LBASSERT( node->left && node->right );
 
-    LBDatas workingSet = datas[ node->mode ];
-    const float leftTime = node->resources > 0 ?
-                           time * node->left->resources / node->resources : 0.f;
-    float timeLeft = LB_MIN( leftTime, time ); // correct for fp rounding error
+    // place the split at the predicted cost share of the left subtree
+    const float cost = ( node->mode == MODE_DB ) ?
+                           _rangeGrid.getCost( _getArea( range )) :
+                           _costGrid.getCost( vp );
+    const float leftCost = node->resources > 0 ?
+                           cost * node->left->resources / node->resources : 0.f;
+    LBLOG( LOG_LB2 ) << "_computeSplit " << vp << ", " << range << " cost "
+                     << cost << ", left " << leftCost << std::endl;
 
     switch( node->mode )
     {
         case MODE_VERTICAL:
         {
-            LBASSERT( range == Range::ALL );
+            LBASSERT( getMode() == MODE_HYBRID || range == Range::ALL );
 
-            float splitPos = vp.x;
+            float splitPos = _costGrid.getSplitX( vp, leftCost );
             const float end = vp.getXEnd();
 
-            while( timeLeft > std::numeric_limits< float >::epsilon() &&
-                   splitPos < end )
-            {
-                LBLOG( LOG_LB2 ) << timeLeft << "ms left using "
-                                << workingSet.size() << " tiles" << std::endl;
-
-                // remove all irrelevant items from working set
-                for( LBDatas::iterator i = workingSet.begin();
-                     i != workingSet.end(); )
-                {
-                    const Data& data = *i;
-                    if( data.vp.getXEnd() > splitPos )
-                        ++i;
-                    else
-                        i = workingSet.erase( i );
-                }
-                if( workingSet.empty( ))
-                    break;
-
-                // find next 'discontinouity' in loads
-                float currentPos = 1.0f;
-                for( LBDatas::const_iterator i = workingSet.begin();
-                     i != workingSet.end(); ++i )
-                {
-                    const Data& data = *i;
-                    if( data.vp.x > splitPos && data.vp.x < currentPos )
-                        currentPos = data.vp.x;
-                    const float xEnd = data.vp.getXEnd();
-                    if( xEnd > splitPos && xEnd < currentPos )
-                        currentPos = xEnd;
-                }
-
-                const float width = currentPos - splitPos;
-                LBASSERTINFO( width > 0.f, currentPos << "<=" << splitPos );
-                LBASSERT( currentPos <= 1.0f );
-
-                // accumulate normalized load in splitPos...currentPos
-                LBLOG( LOG_LB2 ) << "Computing load in X " << splitPos << "..."
-                                 << currentPos << std::endl;
-                float currentTime = 0.f;
-                for( LBDatas::const_iterator i = workingSet.begin();
-                     i != workingSet.end(); ++i )
-                {
-                    const Data& data = *i;
-
-                    if( data.vp.x >= currentPos ) // not yet needed data sets
-                        break;
-
-                    float yContrib = data.vp.h;
-                    if( data.vp.y < vp.y )
-                        yContrib -= (vp.y - data.vp.y);
-
-                    const float dataEnd = data.vp.getYEnd();
-                    const float vpEnd   = vp.getYEnd();
-                    if( dataEnd > vpEnd )
-                        yContrib -= (dataEnd - vpEnd);
-
-                    if( yContrib > 0.f )
-                    {
-                        const float percentage = ( width / data.vp.w ) *
-                                                 ( yContrib / data.vp.h );
-                        currentTime += ( data.time * percentage );
-
-                        LBLOG( LOG_LB2 ) << data.vp << " contributes "
-                                         << yContrib << " in " << vp.h << " ("
-                                         << percentage << ") with " << data.time
-                                         << ": " << ( data.time * percentage )
-                                         << " vp.y " << vp.y << " dataEnd "
-                                         << dataEnd << " vpEnd " << vpEnd
-                                         << std::endl;
-                        LBASSERT( percentage < 1.01f )
-                    }
-                }
-
-                LBLOG( LOG_LB2 ) << splitPos << "..." << currentPos << ": t="
-                                 << currentTime << " of " << timeLeft
-                                 << std::endl;
-
-                if( currentTime >= timeLeft ) // found last region
-                {
-                    splitPos += ( width * timeLeft / currentTime );
-                    timeLeft = 0.0f;
-                }
-                else
-                {
-                    timeLeft -= currentTime;
-                    splitPos  = currentPos;
-                }
-            }
-
             LBLOG( LOG_LB2 ) << "Should split at X " << splitPos << std::endl;
             if( getDamping() < 1.f )
                 splitPos = (1.f - getDamping()) * splitPos +
                             getDamping() * node->split;
             LBLOG( LOG_LB2 ) << "Dampened split at X " << splitPos << std::endl;
 
-            // There might be more time left due to MIN_PIXEL rounding by parent
-            // LBASSERTINFO( timeLeft <= .001f, timeLeft );
-
             // Ensure minimum size
             const Compound* root = getCompound();
             const float pvpW = static_cast< float >(
@@ -762,7 +738,7 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
             // balance children
             Viewport childVP = vp;
             childVP.w = (splitPos - vp.x);
-            _computeSplit( node->left, leftTime, datas, childVP, range );
+            _computeSplit( node->left, childVP, range );
 
             childVP.x = childVP.getXEnd();
             childVP.w = end - childVP.x;
@@ -771,107 +747,16 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
             //   child which is slightly below the parent width. Correct it.
             while( childVP.getXEnd() < end )
                 childVP.w += std::numeric_limits< float >::epsilon();
-            _computeSplit( node->right, time-leftTime, datas, childVP, range );
+            _computeSplit( node->right, childVP, range );
             break;
         }
 
         case MODE_HORIZONTAL:
         {
-            LBASSERT( range == Range::ALL );
-            float splitPos = vp.y;
+            LBASSERT( getMode() == MODE_HYBRID || range == Range::ALL );
+            float splitPos = _costGrid.getSplitY( vp, leftCost );
             const float end = vp.getYEnd();
 
-            while( timeLeft > std::numeric_limits< float >::epsilon() &&
-                   splitPos < end )
-            {
-                LBLOG( LOG_LB2 ) << timeLeft << "ms left using "
-                                 << workingSet.size() << " tiles" << std::endl;
-
-                // remove all unrelevant items from working set
-                for( LBDatas::iterator i = workingSet.begin();
-                     i != workingSet.end(); )
-                {
-                    const Data& data = *i;
-                    if( data.vp.getYEnd() > splitPos )
-                        ++i;
-                    else
-                        i = workingSet.erase( i );
-                }
-                if( workingSet.empty( ))
-                    break;
-
-                // find next 'discontinuouity' in loads
-                float currentPos = 1.0f;
-                for( LBDatas::const_iterator i = workingSet.begin();
-                     i != workingSet.end(); ++i )
-                {
-                    const Data& data = *i;
-                    if( data.vp.y > splitPos && data.vp.y < currentPos )
-                        currentPos = data.vp.y;
-                    const float yEnd = data.vp.getYEnd();
-                    if( yEnd > splitPos && yEnd < currentPos )
-                        currentPos = yEnd;
-                }
-
-                const float height = currentPos - splitPos;
-                LBASSERTINFO( height > 0.f, currentPos << "<=" << splitPos );
-                LBASSERT( currentPos <= 1.0f );
-
-                // accumulate normalized load in splitPos...currentPos
-                LBLOG( LOG_LB2 ) << "Computing load in Y " << splitPos << "..."
-                                << currentPos << std::endl;
-                float currentTime = 0.f;
-                for( LBDatas::const_iterator i = workingSet.begin();
-                     i != workingSet.end(); ++i )
-                {
-                    const Data& data = *i;
-
-                    if( data.vp.y >= currentPos ) // not yet needed data sets
-                        break;
-
-                    float xContrib = data.vp.w;
-
-                    if( data.vp.x < vp.x )
-                        xContrib -= (vp.x - data.vp.x);
-
-                    const float dataEnd = data.vp.getXEnd();
-                    const float vpEnd   = vp.getXEnd();
-                    if( dataEnd > vpEnd )
-                        xContrib -= (dataEnd - vpEnd);
-
-                    if( xContrib > 0.f )
-                    {
-                        const float percentage = ( height / data.vp.h ) *
-                                                 ( xContrib / data.vp.w );
-                        currentTime += ( data.time * percentage );
-
-                        LBLOG( LOG_LB2 ) << data.vp << " contributes "
-                                         << xContrib << " in " << vp.w << " ("
-                                         << percentage << ") with " << data.time
-                                         << ": " << ( data.time * percentage )
-                                         << " total " << currentTime << " vp.x "
-                                         << vp.x << " dataEnd " << dataEnd
-                                         << " vpEnd " << vpEnd << std::endl;
-                        LBASSERT( percentage < 1.01f )
-                    }
-                }
-
-                LBLOG( LOG_LB2 ) << splitPos << "..." << currentPos << ": t="
-                                 << currentTime << " of " << timeLeft
-                                 << std::endl;
-
-                if( currentTime >= timeLeft ) // found last region
-                {
-                    splitPos += (height * timeLeft / currentTime );
-                    timeLeft = 0.0f;
-                }
-                else
-                {
-                    timeLeft -= currentTime;
-                    splitPos  = currentPos;
-                }
-            }
-
             LBLOG( LOG_LB2 ) << "Should split at Y " << splitPos << std::endl;
             if( getDamping() < 1.f )
                 splitPos = (1.f - getDamping( )) * splitPos +
@@ -927,91 +812,22 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
 
             Viewport childVP = vp;
             childVP.h = (splitPos - vp.y);
-            _computeSplit( node->left, leftTime, datas, childVP, range );
+            _computeSplit( node->left, childVP, range );
 
             childVP.y = childVP.getYEnd();
             childVP.h = end - childVP.y;
             while( childVP.getYEnd() < end )
                 childVP.h += std::numeric_limits< float >::epsilon();
-            _computeSplit( node->right, time - leftTime, datas, childVP, range);
+            _computeSplit( node->right, childVP, range );
             break;
         }
 
         case MODE_DB:
         {
             LBASSERT( vp == Viewport::FULL );
-            float splitPos = range.start;
+            float splitPos = _rangeGrid.getSplitX( _getArea( range ),
+                                                   leftCost );
             const float end = range.end;
-
-            while( timeLeft > std::numeric_limits< float >::epsilon() &&
-                   splitPos < end )
-            {
-                LBLOG( LOG_LB2 ) << timeLeft << "ms left using "
-                                 << workingSet.size() << " tiles" << std::endl;
-
-                // remove all irrelevant items from working set
-                for( LBDatas::iterator i = workingSet.begin();
-                     i != workingSet.end(); )
-                {
-                    const Data& data = *i;
-                    if( data.range.end > splitPos )
-                        ++i;
-                    else
-                        i = workingSet.erase( i );
-                }
-                if( workingSet.empty( ))
-                    break;
-
-                // find next 'discontinouity' in loads
-                float currentPos = 1.0f;
-                for( LBDatas::const_iterator i = workingSet.begin();
-                     i != workingSet.end(); ++i )
-                {
-                    const Data& data = *i;
-                    currentPos = LB_MIN( currentPos, data.range.end );
-                }
-
-                const float size = currentPos - splitPos;
-                LBASSERTINFO( size > 0.f, currentPos << "<=" << splitPos );
-                LBASSERT( currentPos <= 1.0f );
-
-                // accumulate normalized load in splitPos...currentPos
-                LBLOG( LOG_LB2 ) << "Computing load in range " << splitPos
-                                << "..." << currentPos << std::endl;
-                float currentTime = 0.f;
-                for( LBDatas::const_iterator i = workingSet.begin();
-                     i != workingSet.end(); ++i )
-                {
-                    const Data& data = *i;
-
-                    if( data.range.start >= currentPos ) // not yet needed data
-                        break;
-#if 0
-                    // make sure we cover full area
-                    LBASSERTINFO(  data.range.start <= splitPos,
-                                   data.range.start << " > " << splitPos );
-                    LBASSERTINFO( data.range.end >= currentPos,
-                                  data.range.end << " < " << currentPos);
-#endif
-                    currentTime += data.time * size / data.range.getSize();
-                }
-
-                LBLOG( LOG_LB2 ) << splitPos << "..." << currentPos << ": t="
-                                 << currentTime << " of " << timeLeft
-                                 << std::endl;
-
-                if( currentTime >= timeLeft ) // found last region
-                {
-                    const float width = currentPos - splitPos;
-                    splitPos += (width * timeLeft / currentTime );
-                    timeLeft = 0.0f;
-                }
-                else
-                {
-                    timeLeft -= currentTime;
-                    splitPos  = currentPos;
-                }
-            }
             LBLOG( LOG_LB2 ) << "Should split at " << splitPos << std::endl;
             if( getDamping() < 1.f )
                 splitPos = (1.f - getDamping( )) * splitPos +
@@ -1042,11 +858,11 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
 
             Range childRange = range;
             childRange.end = splitPos;
-            _computeSplit( node->left, leftTime, datas, vp, childRange );
+            _computeSplit( node->left, vp, childRange );
 
             childRange.start = childRange.end;
             childRange.end   = range.end;
-            _computeSplit( node->right, time - leftTime, datas, vp, childRange);
+            _computeSplit( node->right, vp, childRange );
             break;
         }
 
@@ -1058,8 +874,9 @@ void LoadEqualizer::_computeSplit( Node* node, const float time,
 void LoadEqualizer::_assign( Compound* compound, const Viewport& vp,
                              const Range& range )
 {
-    LBASSERTINFO( vp == Viewport::FULL || range == Range::ALL,
-                  "Mixed 2D/DB load-balancing not implemented" );
+    LBASSERTINFO( getMode() == MODE_HYBRID ||
+                  vp == Viewport::FULL || range == Range::ALL,
+                  "Mixed 2D/DB load-balancing only implemented in HYBRID mode");
 
     compound->setViewport( vp );
     compound->setRange( range );
@@ -1086,8 +903,12 @@ void LoadEqualizer::_assign( Compound* compound, const Viewport& vp,
         data.time = 0;
 
     LBFrameData& frameData = _history.back();
-    LBDatas& items = frameData.second;
+    LBDatas& items = frameData.items;
 
+    if( data.time < 0 )
+        ++frameData.nMissing;
+    frameData.channels.insert( LBIndex::value_type( data.channel,
+                                                    items.size( )));
     items.push_back( data );
 }
 
@@ -20,11 +20,13 @@
 #define EQS_LOADEQUALIZER_H
 
 #include "../channelListener.h" // base class
+#include "costGrid.h"           // member
 #include "equalizer.h"          // base class
 
 #include <eq/client/types.h>
 #include <eq/fabric/range.h>    // member
 #include <eq/fabric/viewport.h> // member
+#include <lunchbox/stdExt.h>    // member
 
 #include <deque>
 #include <vector>
@@ -36,7 +38,13 @@ namespace server
     class LoadEqualizer;
     std::ostream& operator << ( std::ostream& os, const LoadEqualizer* );
 
-    /** Adapts the 2D tiling or DB range of the attached compound's children. */
+    /**
+     * Adapts the 2D tiling or DB range of the attached compound's children.
+     *
+     * In hybrid mode, the upper levels of the split tree partition the DB
+     * range and the lower levels tile the screen. The number of range levels
+     * is adapted from the measured render and assemble times.
+     */
     class LoadEqualizer : public Equalizer, protected ChannelListener
     {
     public:
@@ -67,14 +75,15 @@ namespace server
         struct Node
         {
             Node() : left(0), right(0), compound(0), mode( MODE_VERTICAL )
-                   , resources( 0.0f ), split( 0.5f ), boundaryf( 0.0f )
-                   , resistancef( 0.0f ) {}
+                   , depth( 0 ), resources( 0.0f ), split( 0.5f )
+                   , boundaryf( 0.0f ), resistancef( 0.0f ) {}
             ~Node() { delete left; delete right; }
 
             Node*     left;      //<! Left child (only on non-leafs)
             Node*     right;     //<! Right child (only on non-leafs)
             Compound* compound;  //<! The corresponding child (only on leafs)
             LoadEqualizer::Mode mode; //<! What to adapt
+            uint32_t  depth;     //<! Level in the tree, 0 for the root
             float     resources; //<! total amount of resources of subtree
             float     split;     //<! 0..1 global (vp, range) split
             float     boundaryf;
@@ -102,13 +111,32 @@ namespace server
         };
 
         typedef std::vector< Data > LBDatas;
-        typedef std::pair< uint32_t,  LBDatas > LBFrameData;
+        typedef stde::hash_map< const void*, size_t > LBIndex;
+
+        struct LBFrameData
+        {
+            explicit LBFrameData( const uint32_t frameNumber_ = 0 )
+                    : frameNumber( frameNumber_ ), nMissing( 0 ) {}
+
+            uint32_t frameNumber;
+            LBDatas  items;
+            LBIndex  channels; //!< item index of each channel in items
+            size_t   nMissing; //!< number of items without load data
+        };
 
         std::deque< LBFrameData > _history;
 
+        CostGrid _costGrid;  //!< predicted screen cost learned from _history
+        CostGrid _rangeGrid; //!< predicted range cost learned from _history
+        uint32_t _costFrame; //!< youngest frame learned by the cost grids
+
+        uint32_t _treeDepth;   //!< number of split levels of _tree
+        uint32_t _dbLevels;    //!< split levels using DB in hybrid mode
+        uint32_t _hybridFrame; //!< frame number of the last _dbLevels change
+
         //-------------------- Methods --------------------
         /** @return true if we have a valid LB tree */
-        Node* _buildTree( const Compounds& children );
+        Node* _buildTree( const Compounds& children, const uint32_t depth );
 
         /** Setup assembly with the compound dest value */
         void _updateAssembleTime( Data& data, const Statistic& stat );
@@ -126,29 +154,28 @@ namespace server
         /** Obsolete _history so that front-most item is youngest available. */
         void _checkHistory();
 
+        /** Adapt the number of DB levels to the render and assemble time. */
+        void _updateHybrid( const uint32_t frameNumber );
+
         /** Update all node fields influencing the split */
         void _update( Node* node, const Viewport& vp, const Range& range );
         void _updateLeaf( Node* node );
         void _updateNode( Node* node, const Viewport& vp, const Range& range );
 
-        /** Adjust the split of each node based on the front-most _history. */
+        /** Adjust the split of each node based on the predicted cost. */
         void _computeSplit();
         void _removeEmpty( LBDatas& items );
 
-        void _computeSplit( Node* node, const float time, LBDatas* sortedData,
-                            const eq::Viewport& vp, const eq::Range& range );
+        /** Learn the front-most _history in the cost grids. */
+        void _updateCostGrid();
+
+        void _computeSplit( Node* node, const eq::Viewport& vp,
+                            const eq::Range& range );
         void _assign( Compound* compound, const Viewport& vp,
                       const Range& range );
 
         /** Get the resource for all children compound. */
         float _getTotalResources( ) const;
-
-        static bool _compareX( const Data& data1, const Data& data2 )
-            { return data1.vp.x < data2.vp.x; }
-        static bool _compareY( const Data& data1, const Data& data2 )
-            { return data1.vp.y < data2.vp.y; }
-        static bool _compareRange( const Data& data1, const Data& data2 )
-            { return data1.range.start < data2.range.start; }
     };
 }
 }
@@ -27,6 +27,8 @@
 
 #include "tileEqualizer.h"
 
+#include <eq/client/statistic.h>
+
 namespace eq
 {
 namespace server
@@ -108,12 +110,50 @@ private:
     const std::string& _name;
 };
 
+class LoadSubscriber : public CompoundVisitor
+{
+public:
+    LoadSubscriber( ChannelListener* listener ) : _listener( listener ) {}
+
+    /** Visit a leaf compound. */
+    virtual VisitorResult visitLeaf( Compound* compound )
+    {
+        Channel* channel = compound->getChannel();
+        LBASSERT( channel );
+        channel->addListener( _listener );
+        return TRAVERSE_CONTINUE;
+    }
+
+private:
+    ChannelListener* const _listener;
+};
+
+class LoadUnsubscriber : public CompoundVisitor
+{
+public:
+    LoadUnsubscriber( ChannelListener* listener ) : _listener( listener ) {}
+
+    /** Visit a leaf compound. */
+    virtual VisitorResult visitLeaf( Compound* compound )
+    {
+        Channel* channel = compound->getChannel();
+        LBASSERT( channel );
+        channel->removeListener( _listener );
+        return TRAVERSE_CONTINUE;
+    }
+
+private:
+    ChannelListener* const _listener;
+};
+
 }
 
 TileEqualizer::TileEqualizer()
     : Equalizer()
     , _created( false )
     , _name( "TileEqualizer" )
+    , _strategy( TileQueue::STRATEGY_ZIGZAG )
+    , _stealing( false )
 {
 }
 
@@ -121,7 +161,25 @@ TileEqualizer::TileEqualizer( const TileEqualizer& from )
     : Equalizer( from )
     , _created( from._created )
     , _name( from._name )
+    , _strategy( from._strategy )
+    , _stealing( from._stealing )
+{
+}
+
+TileEqualizer::~TileEqualizer()
+{
+    attach( 0 );
+}
+
+void TileEqualizer::attach( Compound* compound )
 {
+    Compound* oldCompound = getCompound();
+    if( oldCompound && _created && _strategy == TileQueue::STRATEGY_COST )
+    {
+        LoadUnsubscriber unsubscriber( this );
+        oldCompound->accept( unsubscriber );
+    }
+    Equalizer::attach( compound );
 }
 
 void TileEqualizer::_createQueues( Compound* compound )
@@ -135,6 +193,8 @@ void TileEqualizer::_createQueues( Compound* compound )
         server->registerObject( output );
         output->setTileSize( getTileSize( ));
         output->setName( name );
+        output->setStrategy( _strategy );
+        output->setStealing( _stealing );
         output->setAutoObsolete( compound->getConfig()->getLatency( ));
 
         compound->addOutputTileQueue( output );
@@ -142,6 +202,13 @@ void TileEqualizer::_createQueues( Compound* compound )
 
     InputQueueCreator creator( getTileSize(), name );
     compound->accept( creator );
+
+    if( _strategy == TileQueue::STRATEGY_COST )
+    {
+        // per-tile render times of the leaf channels drive the tile order
+        LoadSubscriber subscriber( this );
+        compound->accept( subscriber );
+    }
 }
 
 void TileEqualizer::_destroyQueues( Compound* compound )
@@ -159,6 +226,12 @@ void TileEqualizer::_destroyQueues( Compound* compound )
 
     InputQueueDestroyer destroyer( name );
     compound->accept( destroyer );
+
+    if( _strategy == TileQueue::STRATEGY_COST )
+    {
+        LoadUnsubscriber unsubscriber( this );
+        compound->accept( unsubscriber );
+    }
     _created = false;
 }
 
@@ -172,6 +245,24 @@ void TileEqualizer::notifyUpdatePre( Compound* compound,
         _destroyQueues( compound );
 }
 
+void TileEqualizer::notifyLoadData( Channel*, const uint32_t,
+                                    const Statistics& statistics,
+                                    const Viewport& )
+{
+    const std::string name = std::string( "queue." ) + _name;
+    TileQueue* queue = _findQueue( name, getCompound()->getOutputTileQueues( ));
+    if( !queue )
+        return;
+
+    for( StatisticsCIter i = statistics.begin(); i != statistics.end(); ++i )
+    {
+        const Statistic& stat = *i;
+        if( stat.type == Statistic::CHANNEL_TILE )
+            queue->updateTileCost( stat.tile,
+                                   float( stat.endTime - stat.startTime ));
+    }
+}
+
 std::ostream& operator << ( std::ostream& os, const TileEqualizer* lb )
 {
     if( lb )
@@ -180,8 +271,12 @@ std::ostream& operator << ( std::ostream& os, const TileEqualizer* lb )
            << "tile_equalizer" << std::endl
            << "{" << std::endl
            << "    name \"" << lb->getName() << "\"" << std::endl
-           << "    size " << lb->getTileSize() << std::endl
-           << "}" << std::endl << lunchbox::enableFlush;
+           << "    size " << lb->getTileSize() << std::endl;
+        if( lb->getStrategy() != TileQueue::STRATEGY_ZIGZAG )
+            os << "    strategy " << lb->getStrategy() << std::endl;
+        if( lb->isStealing( ))
+            os << "    stealing ON" << std::endl;
+        os << "}" << std::endl << lunchbox::enableFlush;
     }
     return os;
 }
@@ -19,7 +19,9 @@
 #ifndef EQS_TILEEQUALIZER_H
 #define EQS_TILEEQUALIZER_H
 
-#include "equalizer.h"
+#include "../channelListener.h" // base class
+#include "../tileQueue.h"       // nested enum
+#include "equalizer.h"          // base class
 
 namespace eq
 {
@@ -29,22 +31,43 @@ namespace server
 class TileEqualizer;
 std::ostream& operator << ( std::ostream& os, const TileEqualizer* );
 
-class TileEqualizer : public Equalizer
+class TileEqualizer : public Equalizer, protected ChannelListener
 {
 public:
     EQSERVER_API TileEqualizer();
     TileEqualizer( const TileEqualizer& from );
-    ~TileEqualizer() {}
+    virtual ~TileEqualizer();
+
+    /** @sa Equalizer::attach */
+    virtual void attach( Compound* compound );
 
     /** @sa CompoundListener::notifyUpdatePre */
     virtual void notifyUpdatePre( Compound* compound,
                                   const uint32_t frameNumber );
 
+    /** @sa ChannelListener::notifyLoadData */
+    virtual void notifyLoadData( Channel* channel, const uint32_t frameNumber,
+                                 const Statistics& statistics,
+                                 const Viewport& region );
+
     virtual void toStream( std::ostream& os ) const { os << this; }
     void setName( const std::string& name ) { _name = name; }
 
     const std::string& getName() const { return _name; }
 
+    /** Set the order in which the tiles are generated. */
+    void setStrategy( const TileQueue::Strategy strategy )
+        { _strategy = strategy; }
+
+    /** @return the order in which the tiles are generated. */
+    TileQueue::Strategy getStrategy() const { return _strategy; }
+
+    /** Enable work stealing between the source channels. */
+    void setStealing( const bool onOff ) { _stealing = onOff; }
+
+    /** @return true if work stealing is enabled. */
+    bool isStealing() const { return _stealing; }
+
     virtual uint32_t getType() const { return fabric::TILE_EQUALIZER; }
 
 protected:
@@ -59,6 +82,8 @@ private:
 
     bool _created;
     std::string _name;
+    TileQueue::Strategy _strategy;
+    bool _stealing;
 };
 
 } //server
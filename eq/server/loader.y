@@ -294,8 +294,16 @@
 %token EQTOKEN_2D
 %token EQTOKEN_ASSEMBLE_ONLY_LIMIT
 %token EQTOKEN_DB
+%token EQTOKEN_HYBRID
 %token EQTOKEN_BOUNDARY
 %token EQTOKEN_RESISTANCE
+%token EQTOKEN_STRATEGY
+%token EQTOKEN_ZIGZAG
+%token EQTOKEN_RASTER
+%token EQTOKEN_SPIRAL
+%token EQTOKEN_SQUARE
+%token EQTOKEN_COST
+%token EQTOKEN_STEALING
 %token EQTOKEN_ZOOM
 %token EQTOKEN_MONO
 %token EQTOKEN_STEREO
@@ -318,6 +326,7 @@
     co::ConnectionType   _connectionType;
     eq::server::LoadEqualizer::Mode _loadEqualizerMode;
     eq::server::TreeEqualizer::Mode _treeEqualizerMode;
+    eq::server::TileQueue::Strategy _tileStrategy;
     float                   _viewport[4];
 }
 
@@ -328,6 +337,7 @@
 %type <_connectionType>   connectionType;
 %type <_loadEqualizerMode> loadEqualizerMode;
 %type <_treeEqualizerMode> treeEqualizerMode;
+%type <_tileStrategy>     tileStrategy;
 %type <_viewport>         viewport;
 %type <_float>            FLOAT;
 
@@ -1279,6 +1289,7 @@ loadEqualizerMode:
     | EQTOKEN_DB         { $$ = eq::server::LoadEqualizer::MODE_DB; }
     | EQTOKEN_HORIZONTAL { $$ = eq::server::LoadEqualizer::MODE_HORIZONTAL; }
     | EQTOKEN_VERTICAL   { $$ = eq::server::LoadEqualizer::MODE_VERTICAL; }
+    | EQTOKEN_HYBRID     { $$ = eq::server::LoadEqualizer::MODE_HYBRID; }
 
 treeEqualizerFields: /* null */ | treeEqualizerFields treeEqualizerField
 treeEqualizerField:
@@ -1302,6 +1313,16 @@ tileEqualizerField:
     EQTOKEN_NAME STRING                   { tileEqualizer->setName( $2 ); }
     | EQTOKEN_SIZE '[' UNSIGNED UNSIGNED ']'
                    { tileEqualizer->setTileSize( eq::Vector2i( $3, $4 )); }
+    | EQTOKEN_STRATEGY tileStrategy { tileEqualizer->setStrategy( $2 ); }
+    | EQTOKEN_STEALING IATTR
+        { tileEqualizer->setStealing( $2 == eq::fabric::ON ); }
+
+tileStrategy:
+    EQTOKEN_ZIGZAG   { $$ = eq::server::TileQueue::STRATEGY_ZIGZAG; }
+    | EQTOKEN_RASTER { $$ = eq::server::TileQueue::STRATEGY_RASTER; }
+    | EQTOKEN_SPIRAL { $$ = eq::server::TileQueue::STRATEGY_SPIRAL; }
+    | EQTOKEN_SQUARE { $$ = eq::server::TileQueue::STRATEGY_SQUARE; }
+    | EQTOKEN_COST   { $$ = eq::server::TileQueue::STRATEGY_COST; }
 
 swapBarrier:
     EQTOKEN_SWAPBARRIER '{' { swapBarrier = new eq::server::SwapBarrier; }
@@ -1358,6 +1379,8 @@ tileQueueField:
     EQTOKEN_NAME STRING { tileQueue->setName( $2 ); }
     | EQTOKEN_SIZE '[' UNSIGNED UNSIGNED ']'
         { tileQueue->setTileSize( eq::Vector2i( $3, $4 )); }
+    | EQTOKEN_STRATEGY tileStrategy { tileQueue->setStrategy( $2 ); }
+    | EQTOKEN_STEALING IATTR { tileQueue->setStealing( $2 == eq::fabric::ON ); }
 
 compoundAttributes: /*null*/ | compoundAttributes compoundAttribute
 compoundAttribute:
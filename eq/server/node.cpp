@@ -564,7 +564,6 @@ void Node::update( const uint128_t& frameID, const uint32_t frameNumber )
     LBLOG( LOG_TASKS ) << "TASK node tasks finish " << std::endl;
 
     _finish( frameNumber );
-    flushSendBuffer();
 }
 
 uint32_t Node::_getFinishLatency() const
@@ -610,16 +609,22 @@ void Node::_finish( const uint32_t currentFrame )
         {
             const uint32_t latency = _getFinishLatency();
             if( currentFrame > latency )
-                flushFrames( currentFrame - latency );
+                _finishFrames( currentFrame - latency );
             return;
         }
     }
 
     // else only non-threaded pipes, all local tasks are done, send finish now.
-    flushFrames( currentFrame );
+    _finishFrames( currentFrame );
 }
 
 void Node::flushFrames( const uint32_t frameNumber )
+{
+    _finishFrames( frameNumber );
+    flushSendBuffer();
+}
+
+void Node::_finishFrames( const uint32_t frameNumber )
 {
     LBLOG( LOG_TASKS ) << "Flush frames including " << frameNumber << std::endl;
 
@@ -628,8 +633,6 @@ void Node::flushFrames( const uint32_t frameNumber )
         ++_flushedFrame;
         _sendFrameFinish( _flushedFrame );
     }
-
-    flushSendBuffer();
 }
 
 void Node::_sendFrameFinish( const uint32_t frameNumber )
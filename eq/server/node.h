@@ -126,6 +126,10 @@ namespace server
         /**
          * Trigger the rendering of a new frame for this node.
          *
+         * The generated tasks are buffered until flushSendBuffer() is
+         * called. The update only modifies this node and its children, and
+         * may run concurrently with the update of other nodes.
+         *
          * @param frameID a per-frame identifier passed to all rendering
          *                methods.
          * @param frameNumber the number of the frame.
@@ -293,6 +297,7 @@ namespace server
 
         uint32_t _getFinishLatency() const;
         void _finish( const uint32_t currentFrame );
+        void _finishFrames( const uint32_t frameNumber );
 
         /** flush cached barriers. */
         void _flushBarriers();
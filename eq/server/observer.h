@@ -66,7 +66,7 @@ namespace server
          */
         //@{
         /** Initialize the observer parameters. */
-        void init();
+        EQSERVER_API void init();
 
         /** Schedule deletion of this observer. */
         void postDelete();
@@ -23,6 +23,8 @@
 #include <co/dataOStream.h>
 #include <co/queueItem.h>
 
+#include <algorithm>
+
 namespace eq
 {
 namespace server
@@ -33,9 +35,9 @@ TileQueue::TileQueue()
         , _compound( 0 )
         , _name()
         , _size( 0, 0 )
+        , _strategy( STRATEGY_ZIGZAG )
+        , _stealing( false )
 {
-    for( unsigned i = 0; i < NUM_EYES; ++i )
-        _queueMaster[i] = 0;
 }
 
 TileQueue::TileQueue( const TileQueue& from )
@@ -43,9 +45,9 @@ TileQueue::TileQueue( const TileQueue& from )
         , _compound( 0 )
         , _name( from._name )
         , _size( from._size )
+        , _strategy( from._strategy )
+        , _stealing( from._stealing )
 {
-    for( unsigned i = 0; i < NUM_EYES; ++i )
-        _queueMaster[i] = 0;
 }
 
 TileQueue::~TileQueue()
@@ -57,41 +59,143 @@ void TileQueue::addTile( const Tile& tile, const fabric::Eye eye )
 {
     uint32_t index = lunchbox::getIndexOfLastBit(eye);
     LBASSERT( index < NUM_EYES );
-    _queueMaster[index]->_queue.push() << tile;
+    LBASSERT( !_queueMaster[index].empty( ));
+
+    if( _queueMaster[index].size() > 1 )
+        _tiles[index].push_back( tile );
+    else
+        _queueMaster[index].front()->_queue.push() << tile;
+}
+
+void TileQueue::distributeTiles()
+{
+    for( unsigned i = 0; i < NUM_EYES; ++i )
+    {
+        std::vector< Tile >& tiles = _tiles[i];
+        const size_t nConsumers = _queueMaster[i].size() / 2;
+        if( tiles.empty() || nConsumers == 0 )
+            continue;
+
+        const size_t nTiles = tiles.size();
+        for( size_t j = 0; j < nConsumers; ++j )
+        {
+            size_t begin, middle, end;
+            getRange( nTiles, nConsumers, j, begin, middle, end );
+
+            // private half in order, stealable half from the end
+            co::QueueMaster& own = _queueMaster[i][ 2 * j ]->_queue;
+            for( size_t k = begin; k < middle; ++k )
+                own.push() << tiles[k];
+
+            co::QueueMaster& stealable = _queueMaster[i][ 2 * j + 1 ]->_queue;
+            for( size_t k = end; k > middle; --k )
+                stealable.push() << tiles[ k - 1 ];
+        }
+        tiles.clear();
+    }
+}
+
+void TileQueue::getRange( const size_t nTiles, const size_t nConsumers,
+                          const size_t consumer, size_t& begin,
+                          size_t& middle, size_t& end )
+{
+    LBASSERT( consumer < nConsumers );
+    begin = consumer * nTiles / nConsumers;
+    end = ( consumer + 1 ) * nTiles / nConsumers;
+    middle = begin + ( end - begin + 1 ) / 2;
+}
+
+std::vector< size_t > TileQueue::getDrainOrder( const size_t nConsumers,
+                                                const size_t consumer )
+{
+    std::vector< size_t > order;
+    if( nConsumers == 0 )
+        return order;
+
+    const bool isConsumer = consumer < nConsumers;
+    if( isConsumer )
+        order.push_back( 2 * consumer );
+
+    // steal from the following consumers
+    for( size_t i = 0; i < nConsumers; ++i )
+        order.push_back( 2 * (( consumer + i ) % nConsumers ) + 1 );
+
+    // help consumers which did not drain their private range
+    for( size_t i = isConsumer ? 1 : 0; i < nConsumers; ++i )
+        order.push_back( 2 * (( consumer + i ) % nConsumers ));
+    return order;
+}
+
+void TileQueue::setConsumers( const Eye eye, const Compounds& consumers )
+{
+    const uint32_t index = lunchbox::getIndexOfLastBit( eye );
+    LBASSERT( index < NUM_EYES );
+    _consumers[ index ] = consumers;
+}
+
+void TileQueue::updateTileCost( const uint32_t index, const float time )
+{
+    if( index >= _costs.size( )) // measured on an outdated tile grid
+        return;
+
+    // average with the history to smooth out the millisecond clock resolution
+    float& cost = _costs[ index ];
+    cost = ( cost > 0.f ) ? .5f * ( cost + time ) : time;
+}
+
+void TileQueue::resetTileCosts( const size_t nTiles )
+{
+    _costs.assign( nTiles, 0.f );
 }
 
 void TileQueue::cycleData( const uint32_t frameNumber, const Compound* compound)
 {
     for( unsigned i = 0; i < NUM_EYES; ++i )
     {
+        _queueMaster[i].clear();
+        _tiles[i].clear();
         if( !compound->isInheritActive( Eye( 1<<i )))// eye pass not used
         {
-            _queueMaster[i] = 0;
+            _consumers[i].clear();
             continue;
         }
 
-        // reuse unused queues
-        LatencyQueue* queue    = _queues.empty() ? 0 : _queues.back();
-        const uint32_t latency = getAutoObsolete();
-        const uint32_t dataAge = queue ? queue->_frameNumber : 0;
-
-        if( queue && dataAge < frameNumber-latency && frameNumber > latency )
-            // not used anymore
-            _queues.pop_back();
-        else // still used - allocate new data
+        if( !_stealing || _consumers[i].empty( ))
         {
-            queue = new LatencyQueue;
-
-            getLocalNode()->registerObject( &queue->_queue );
-            queue->_queue.setAutoObsolete( 1 ); // current + in use by render nodes
+            _consumers[i].clear();
+            _queueMaster[i].push_back( _newQueue( frameNumber ));
+            continue;
         }
 
-        queue->_queue.clear();
-        queue->_frameNumber = frameNumber;
+        const size_t nQueues = 2 * _consumers[i].size();
+        for( size_t j = 0; j < nQueues; ++j )
+            _queueMaster[i].push_back( _newQueue( frameNumber ));
+    }
+}
+
+TileQueue::LatencyQueue* TileQueue::_newQueue( const uint32_t frameNumber )
+{
+    // reuse unused queues
+    LatencyQueue* queue    = _queues.empty() ? 0 : _queues.back();
+    const uint32_t latency = getAutoObsolete();
+    const uint32_t dataAge = queue ? queue->_frameNumber : 0;
+
+    if( queue && dataAge < frameNumber-latency && frameNumber > latency )
+        // not used anymore
+        _queues.pop_back();
+    else // still used - allocate new data
+    {
+        queue = new LatencyQueue;
 
-        _queues.push_front( queue );
-        _queueMaster[i] = queue;
+        getLocalNode()->registerObject( &queue->_queue );
+        queue->_queue.setAutoObsolete( 1 ); // current + in use by render nodes
     }
+
+    queue->_queue.clear();
+    queue->_frameNumber = frameNumber;
+
+    _queues.push_front( queue );
+    return queue;
 }
 
 void TileQueue::setOutputQueue( TileQueue* queue, const Compound* compound )
@@ -130,18 +234,34 @@ void TileQueue::unsetData()
 {
     for( unsigned i = 0; i < NUM_EYES; ++i )
     {
-        _queueMaster[i] = 0;
+        _queueMaster[i].clear();
+        _consumers[i].clear();
+        _tiles[i].clear();
         _outputQueue[i] = 0;
     }
 }
 
-const UUID TileQueue::getQueueMasterID( const Eye eye ) const
+std::vector< UUID > TileQueue::getQueueMasterIDs( const Eye eye,
+                                          const Compound* consumer ) const
 {
-    uint32_t index = lunchbox::getIndexOfLastBit(eye);
-    LatencyQueue* queue = _queueMaster[ index ];
-    if ( queue )
-        return queue->_queue.getID();
-    return UUID();
+    const uint32_t index = lunchbox::getIndexOfLastBit( eye );
+    const std::vector< LatencyQueue* >& queues = _queueMaster[ index ];
+    const Compounds& consumers = _consumers[ index ];
+    std::vector< UUID > ids;
+
+    if( consumers.empty( ))
+    {
+        if( !queues.empty( ))
+            ids.push_back( queues.front()->_queue.getID( ));
+        return ids;
+    }
+
+    const size_t own = std::find( consumers.begin(), consumers.end(),
+                                  consumer ) - consumers.begin();
+    const std::vector< size_t > order = getDrainOrder( consumers.size(), own );
+    for( size_t i = 0; i < order.size(); ++i )
+        ids.push_back( queues[ order[i] ]->_queue.getID( ));
+    return ids;
 }
 
 std::ostream& operator << ( std::ostream& os, const TileQueue* tileQueue )
@@ -159,9 +279,26 @@ std::ostream& operator << ( std::ostream& os, const TileQueue* tileQueue )
     if( size != Vector2i::ZERO )
         os << "size      " << size << std::endl;
 
+    const TileQueue::Strategy strategy = tileQueue->getStrategy();
+    if( strategy != TileQueue::STRATEGY_ZIGZAG )
+        os << "strategy  " << strategy << std::endl;
+    if( tileQueue->isStealing( ))
+        os << "stealing  ON" << std::endl;
+
     os << lunchbox::exdent << "}" << std::endl << lunchbox::enableFlush;
     return os;
 }
 
+std::ostream& operator << ( std::ostream& os,
+                            const TileQueue::Strategy strategy )
+{
+    os << ( strategy == TileQueue::STRATEGY_ZIGZAG ? "ZIGZAG" :
+            strategy == TileQueue::STRATEGY_RASTER ? "RASTER" :
+            strategy == TileQueue::STRATEGY_SPIRAL ? "SPIRAL" :
+            strategy == TileQueue::STRATEGY_SQUARE ? "SQUARE" :
+            strategy == TileQueue::STRATEGY_COST   ? "COST" : "ERROR" );
+    return os;
+}
+
 }
 }
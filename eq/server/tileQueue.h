@@ -22,6 +22,7 @@
 #include "compound.h"
 #include "types.h"
 
+#include <eq/fabric/tile.h>         // member
 #include <lunchbox/bitOperation.h> // function getIndexOfLastBit
 #include <co/queueMaster.h>
 
@@ -33,6 +34,17 @@ namespace server
     class TileQueue : public co::Object
     {
     public:
+        /** The order in which the tiles are put into the queue. */
+        enum Strategy
+        {
+            STRATEGY_ZIGZAG = 0, //!< row-wise, alternating direction
+            STRATEGY_RASTER,     //!< row-wise, left to right
+            STRATEGY_SPIRAL,     //!< outward from the center
+            STRATEGY_SQUARE,     //!< by growing squares from the origin
+            /** Most expensive tiles of the last frame first */
+            STRATEGY_COST
+        };
+
         /**
          * Constructs a new TileQueue.
          */
@@ -60,9 +72,59 @@ namespace server
         /** @return the tile size. */
         const Vector2i& getTileSize() const { return _size; }
 
+        /** Set the tile ordering strategy. */
+        void setStrategy( const Strategy strategy ) { _strategy = strategy; }
+
+        /** @return the tile ordering strategy. */
+        Strategy getStrategy() const { return _strategy; }
+
+        /**
+         * Update the render cost of a tile from a load measurement.
+         *
+         * @param index the row-major index of the tile in the tile grid.
+         * @param time the time spent on the tile, in milliseconds.
+         */
+        void updateTileCost( const uint32_t index, const float time );
+
+        /** @return the per-tile render costs, indexed by tile index. */
+        const std::vector< float >& getTileCosts() const { return _costs; }
+
+        /** Reset the per-tile costs, e.g., after the tile grid changed. */
+        void resetTileCosts( const size_t nTiles );
+
+        /**
+         * Enable work stealing between the channels using this queue.
+         *
+         * Each consumer gets its own contiguous range of tiles. The first
+         * half of the range is private, the second half can be stolen from
+         * the end by idle consumers. Once all stealable halves are empty,
+         * idle consumers also drain the private halves of the others, so that
+         * no tiles are lost if a consumer does not pull from the queue.
+         */
+        void setStealing( const bool onOff ) { _stealing = onOff; }
+
+        /** @return true if work stealing is enabled. */
+        bool isStealing() const { return _stealing; }
+
+        /**
+         * Set the compounds pulling tiles from this output queue.
+         *
+         * Used in stealing mode to allocate one range per consumer. Has to be
+         * called before cycleData().
+         */
+        void setConsumers( const Eye eye, const Compounds& consumers );
+
         /** Add a tile to the queue. */
         void addTile( const Tile& tile, const Eye eye );
 
+        /**
+         * Distribute the added tiles to the consumer ranges.
+         *
+         * Tiles are kept in the order they were added. Does nothing if work
+         * stealing is disabled.
+         */
+        void distributeTiles();
+
         /**
          * Cycle the current tile queue.
          *
@@ -88,7 +150,48 @@ namespace server
         void flush();
         //@}
 
-        const UUID getQueueMasterID( const Eye eye ) const;
+        /**
+         * @return the identifiers of the queues to drain by the given
+         *         consumer, in order.
+         * @sa getDrainOrder()
+         */
+        std::vector< UUID > getQueueMasterIDs( const Eye eye,
+                                              const Compound* consumer ) const;
+
+        /**
+         * Compute the tile range of a consumer in stealing mode.
+         *
+         * @param nTiles the number of tiles to distribute.
+         * @param nConsumers the number of consumers.
+         * @param consumer the index of the consumer.
+         * @param begin returns the first tile of the range.
+         * @param middle returns the first stealable tile of the range.
+         * @param end returns the end of the range.
+         * @version 1.5.2
+         */
+        EQSERVER_API static void getRange( const size_t nTiles,
+                                           const size_t nConsumers,
+                                           const size_t consumer,
+                                           size_t& begin, size_t& middle,
+                                           size_t& end );
+
+        /**
+         * Compute the order in which a consumer drains the queues in stealing
+         * mode.
+         *
+         * The private queue of consumer i has the index 2i, its stealable
+         * queue 2i+1. A consumer first drains its private queue, then all
+         * stealable queues starting with its own, and finally the private
+         * queues of the other consumers.
+         *
+         * @param nConsumers the number of consumers.
+         * @param consumer the index of the consumer, or nConsumers for a
+         *                 compound which is not a consumer.
+         * @return the queue indices, in drain order.
+         * @version 1.5.2
+         */
+        EQSERVER_API static std::vector< size_t > getDrainOrder(
+            const size_t nConsumers, const size_t consumer );
 
     protected:
         EQSERVER_API virtual ChangeType getChangeType() const
@@ -113,17 +216,38 @@ namespace server
         /** The size of each tile in the queue. */
         Vector2i _size;
 
+        /** The tile ordering strategy. */
+        Strategy _strategy;
+
+        /** The smoothed render cost of each tile. */
+        std::vector< float > _costs;
+
+        /** Per-consumer tile ranges with stealing. */
+        bool _stealing;
+
+        /** The consumers of the current frame, for stealing. */
+        Compounds _consumers[ NUM_EYES ];
+
+        /** Tiles added in stealing mode, to be distributed. */
+        std::vector< Tile > _tiles[ NUM_EYES ];
+
         /** The collage queue pool. */
         std::deque< LatencyQueue* > _queues;
 
-        /** the currently used tile queues */
-        LatencyQueue* _queueMaster[ NUM_EYES ];
+        /**
+         * The currently used tile queues. In stealing mode the private and
+         * stealable range of consumer i are at 2i and 2i+1.
+         */
+        std::vector< LatencyQueue* > _queueMaster[ NUM_EYES ];
 
         /** The current output queue. */
         TileQueue* _outputQueue[ NUM_EYES ];
+
+        LatencyQueue* _newQueue( const uint32_t frameNumber );
     };
 
     std::ostream& operator << ( std::ostream& os, const TileQueue* frame );
+    std::ostream& operator << ( std::ostream& os, const TileQueue::Strategy );
 }
 }
 #endif // EQSERVER_TILEQUEUE_H
@@ -0,0 +1,80 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQSERVER_TILES_COSTSTRATEGY_H
+#define EQSERVER_TILES_COSTSTRATEGY_H
+
+#include "zigzagStrategy.h"
+
+#include <algorithm>
+
+namespace eq
+{
+namespace server
+{
+namespace tiles
+{
+    /**
+     * Generates tiles for a channel, most expensive tiles first.
+     *
+     * Implements a largest-processing-time-first schedule using the per-tile
+     * costs of the previous frames, so that no expensive tile is picked up
+     * last. Tiles of equal cost, or all tiles if no costs are known for the
+     * current tile grid, keep the zigzag order.
+     */
+    class CostStrategy
+    {
+    public:
+        CostStrategy( const std::vector< float >& costs ) : _costs( costs ) {}
+
+        void operator()( std::vector< Vector2i >& tiles, const Vector2i& dim )
+        {
+            ZigzagStrategy zigzag;
+            zigzag( tiles, dim );
+
+            if( _costs.size() != size_t( dim.x() * dim.y( )))
+                return;
+
+            std::stable_sort( tiles.begin(), tiles.end(),
+                              CompareCost( _costs, dim.x( )));
+        }
+
+    private:
+        const std::vector< float >& _costs;
+
+        class CompareCost
+        {
+        public:
+            CompareCost( const std::vector< float >& costs, const int width )
+                : _costs( costs ), _width( width ) {}
+
+            bool operator()( const Vector2i& a, const Vector2i& b ) const
+            {
+                return _costs[ a.y() * _width + a.x() ] >
+                       _costs[ b.y() * _width + b.x() ];
+            }
+
+        private:
+            const std::vector< float >& _costs;
+            const int _width;
+        };
+    };
+}
+}
+}
+
+#endif // EQSERVER_TILES_COSTSTRATEGY_H
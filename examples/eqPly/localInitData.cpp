@@ -116,7 +116,8 @@ void LocalInitData::parseArguments( const int argc, char** argv )
         TCLAP::ValueArg<std::string> wsArg( "w", "windowSystem", wsHelp,
                                             false, "auto", "string", command );
         TCLAP::ValueArg<std::string> modeArg( "c", "renderMode",
-                                 "Rendering Mode (immediate, displayList, VBO)",
+                                "Rendering Mode (immediate, displayList, VBO, "
+                                "packedVBO, multiDraw)",
                                               false, "auto", "string",
                                               command );
         TCLAP::SwitchArg glslArg( "g", "glsl", "Enable GLSL shaders",
@@ -174,6 +175,10 @@ void LocalInitData::parseArguments( const int argc, char** argv )
                 setRenderMode( mesh::RENDER_MODE_DISPLAY_LIST );
             else if( mode == "vbo" )
                 setRenderMode( mesh::RENDER_MODE_BUFFER_OBJECT );
+            else if( mode == "packedvbo" )
+                setRenderMode( mesh::RENDER_MODE_PACKED_BUFFER_OBJECT );
+            else if( mode == "multidraw" )
+                setRenderMode( mesh::RENDER_MODE_MULTI_DRAW );
         }
 
         if( pathArg.isSet( ))
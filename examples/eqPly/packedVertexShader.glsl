@@ -0,0 +1,69 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+    
+// Vertex shader for Phong/Blinn-Phong Shading with one light source, decoding
+// the packed vertex format of VertexBufferLeaf::setupPackedRendering.
+
+
+attribute vec3 packedPosition; // normalized to the leaf bounding box
+attribute vec2 packedNormal;   // octahedral encoding
+attribute vec3 leafOrigin;     // constant per leaf: bounding box minimum
+attribute vec3 leafScale;      // constant per leaf: bounding box extent
+
+varying vec3 normalEye;
+varying vec4 positionEye;
+
+
+vec3 decodeNormal( vec2 encoded )
+{
+    vec3 normal = vec3( encoded, 1.0 - abs( encoded.x ) - abs( encoded.y ));
+    if( normal.z < 0.0 )
+    {
+        vec2 signs = vec2( normal.x >= 0.0 ? 1.0 : -1.0,
+                           normal.y >= 0.0 ? 1.0 : -1.0 );
+        normal.xy = ( 1.0 - abs( normal.yx )) * signs;
+    }
+    return normalize( normal );
+}
+
+void main()
+{
+    vec4 vertex = vec4( leafOrigin + packedPosition * leafScale, 1.0 );
+
+    // transform normal to eye coordinates
+    normalEye = normalize( gl_NormalMatrix * decodeNormal( packedNormal ));
+    
+    // transform position to eye coordinates
+    positionEye = normalize( gl_ModelViewMatrix * vertex );
+    
+    // transform position to screen coordinates
+    gl_Position = gl_ModelViewProjectionMatrix * vertex;
+    
+    // pass the vertex colors on to the fragment shader
+    gl_FrontColor = gl_Color;
+}
@@ -132,7 +132,7 @@ namespace mesh
     const Index             LEAF_SIZE( 21845 );
 
     // binary mesh file version, increment if changing the file format
-    const unsigned short    FILE_VERSION ( 0x0118 );
+    const unsigned short    FILE_VERSION ( 0x0119 );
 
     // enumeration for the sort axis
     enum Axis
@@ -157,19 +157,33 @@ namespace mesh
         INDEX_OBJECT
     };
 
+    // generic vertex attributes of the packed vertex shader
+    enum PackedAttribute
+    {
+        PACKED_POSITION_ATTRIBUTE = 0, // 3 x uint16, normalized to leaf box
+        PACKED_NORMAL_ATTRIBUTE = 1,   // 2 x int8, octahedral encoding
+        PACKED_ORIGIN_ATTRIBUTE = 6,   // constant per leaf: box minimum
+        PACKED_SCALE_ATTRIBUTE = 7     // constant per leaf: box extent
+    };
+
     // enumeration for the render modes
     enum RenderMode
     {
         RENDER_MODE_IMMEDIATE = 0,
         RENDER_MODE_DISPLAY_LIST,
         RENDER_MODE_BUFFER_OBJECT,
+        RENDER_MODE_PACKED_BUFFER_OBJECT,
+        RENDER_MODE_MULTI_DRAW,
         RENDER_MODE_ALL // must be last
     };
     inline std::ostream& operator << ( std::ostream& os, const RenderMode mode )
     {
         os << ( mode == RENDER_MODE_IMMEDIATE     ? "immediate mode" :
                 mode == RENDER_MODE_DISPLAY_LIST  ? "display list mode" :
-                mode == RENDER_MODE_BUFFER_OBJECT ? "VBO mode" : "ERROR" );
+                mode == RENDER_MODE_BUFFER_OBJECT ? "VBO mode" :
+                mode == RENDER_MODE_PACKED_BUFFER_OBJECT ? "packed VBO mode" :
+                mode == RENDER_MODE_MULTI_DRAW    ? "multi draw mode" :
+                "ERROR" );
         return os;
     }
 
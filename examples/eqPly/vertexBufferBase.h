@@ -48,6 +48,7 @@ namespace mesh
     // defined elsewhere
     class VertexData;
     class VertexBufferData;
+    class VertexBufferFlat;
     class VertexBufferState;
         
     /*  The abstract base class for all kinds of kd-tree nodes.  */
@@ -77,21 +78,6 @@ namespace mesh
             _range[1] = 1.0f;
         }
         
-        virtual void toStream( std::ostream& os )
-        {
-            os.write( reinterpret_cast< char* >( &_boundingSphere ), 
-                      sizeof( BoundingSphere ) );
-            os.write( reinterpret_cast< char* >( &_range ), sizeof( Range ) );
-        }
-        
-        virtual void fromMemory( char** addr, VertexBufferData& globalData )
-        {
-            memRead( reinterpret_cast< char* >( &_boundingSphere ), addr, 
-                     sizeof( BoundingSphere ) );
-            memRead( reinterpret_cast< char* >( &_range ), addr, 
-                     sizeof( Range ) );
-        }
-        
         virtual void setupTree( VertexData& data, const Index start,
                                 const Index length, const Axis axis,
                                 const size_t depth,
@@ -102,6 +88,7 @@ namespace mesh
         BoundingSphere  _boundingSphere;
         Range           _range;
         friend class eqPly::VertexBufferDist;
+        friend class VertexBufferFlat;
 
     private:
     };
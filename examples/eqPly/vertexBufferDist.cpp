@@ -241,6 +241,12 @@ void VertexBufferDist::applyInstanceData( co::DataIStream& is )
     is >> base->_boundingSphere >> base->_range;
 
     _node = base;
+    if( _isRoot ) // complete, all children are mapped
+    {
+        mesh::VertexBufferRoot* root = 
+            const_cast< mesh::VertexBufferRoot* >( _root );
+        root->_flat.setup( root );
+    }
 }
 
 }
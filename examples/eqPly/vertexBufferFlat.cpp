@@ -0,0 +1,227 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "vertexBufferFlat.h"
+#include "vertexBufferData.h"
+#include "vertexBufferLeaf.h"
+#include "vertexBufferNode.h"
+
+namespace mesh
+{
+namespace
+{
+/*  Alignment of the arrays in the file, relative to the file start.  */
+static const size_t ALIGNMENT = 16;
+
+void _pad( std::ostream& os )
+{
+    static const char zeros[ ALIGNMENT ] = { 0 };
+    const size_t position = size_t( os.tellp( ));
+    os.write( zeros, ( ALIGNMENT - position % ALIGNMENT ) % ALIGNMENT );
+}
+
+void _skip( char** addr )
+{
+    const size_t position = reinterpret_cast< size_t >( *addr );
+    *addr += ( ALIGNMENT - position % ALIGNMENT ) % ALIGNMENT;
+}
+
+template< class T >
+void _write( std::ostream& os, const T* data, const size_t length )
+{
+    _pad( os );
+    if( length > 0 )
+        os.write( reinterpret_cast< const char* >( data ), 
+                  length * sizeof( T ));
+}
+
+/*  Return the array at the given address, the mapping has to be aligned.  */
+template< class T > const T* _read( char** addr, const size_t length )
+{
+    _skip( addr );
+    const T* data = reinterpret_cast< const T* >( *addr );
+    *addr += length * sizeof( T );
+    return data;
+}
+
+template< class T > const T* _ptr( const std::vector< T >& data )
+{
+    return data.empty() ? 0 : &data[0];
+}
+}
+
+void VertexBufferFlat::clear()
+{
+    _nNodes = 0;
+    _nLeaves = 0;
+    _nodes.clear();
+    _sphereData.clear();
+    _rangeData.clear();
+    _childData.clear();
+    _boxData.clear();
+    _vertexStartData.clear();
+    _indexStartData.clear();
+    _indexLengthData.clear();
+    _vertexLengthData.clear();
+    _setPointers();
+}
+
+/*  Flatten the tree in breadth-first order, using _nodes as queue.  */
+void VertexBufferFlat::setup( const VertexBufferNode* root )
+{
+    clear();
+    _nodes.push_back( root );
+
+    for( size_t i = 0; i < _nodes.size(); ++i )
+    {
+        const VertexBufferBase* node = _nodes[i];
+        _sphereData.push_back( node->getBoundingSphere( ));
+        _rangeData.push_back( Range( node->getRange( )));
+
+        const VertexBufferBase* left  = node->getLeft();
+        const VertexBufferBase* right = node->getRight();
+        if( left && right )
+        {
+            _childData.push_back( uint32_t( _nodes.size( )));
+            _nodes.push_back( left );
+            _nodes.push_back( right );
+            continue;
+        }
+
+        MESHASSERT( !left && !right );
+        const VertexBufferLeaf* leaf = 
+            static_cast< const VertexBufferLeaf* >( node );
+        _childData.push_back( LEAF_FLAG | uint32_t( _boxData.size( )));
+        _boxData.push_back( leaf->_boundingBox );
+        _vertexStartData.push_back( leaf->_vertexStart );
+        _indexStartData.push_back( leaf->_indexStart );
+        _indexLengthData.push_back( leaf->_indexLength );
+        _vertexLengthData.push_back( leaf->_vertexLength );
+    }
+
+    _nNodes = _nodes.size();
+    _nLeaves = _boxData.size();
+    _setPointers();
+}
+
+/*  Create the tree nodes in breadth-first order, using _nodes as queue.  */
+void VertexBufferFlat::createTree( VertexBufferNode* root, 
+                                   VertexBufferData& globalData )
+{
+    if( _nNodes == 0 || isLeaf( 0 ))
+        throw MeshException( "Error reading binary file. Expected the root "
+                             "node, but found something else instead." );
+    _nodes.assign( _nNodes, 0 );
+    _nodes[0] = root;
+
+    for( size_t i = 0; i < _nNodes; ++i )
+    {
+        VertexBufferBase* node = const_cast< VertexBufferBase* >( _nodes[i] );
+        node->_boundingSphere = _spheres[i];
+        node->_range = _ranges[i];
+
+        if( isLeaf( i ))
+        {
+            const size_t j = _children[i] & ~LEAF_FLAG;
+            if( j >= _nLeaves )
+                throw MeshException( "Error reading binary file. Leaf "
+                                     "index out of range." );
+            VertexBufferLeaf* leaf = static_cast< VertexBufferLeaf* >( node );
+            leaf->_boundingBox = _boxes[j];
+            leaf->_vertexStart = _vertexStarts[j];
+            leaf->_indexStart = _indexStarts[j];
+            leaf->_indexLength = _indexLengths[j];
+            leaf->_vertexLength = _vertexLengths[j];
+            continue;
+        }
+
+        const size_t left = getLeft( i );
+        if( left <= i || left + 1 >= _nNodes )
+            throw MeshException( "Error reading binary file. Child node "
+                                 "index out of range." );
+
+        VertexBufferNode* parent = static_cast< VertexBufferNode* >( node );
+        for( size_t child = left; child <= left + 1; ++child )
+        {
+            if( isLeaf( child ))
+                _nodes[ child ] = new VertexBufferLeaf( globalData );
+            else
+                _nodes[ child ] = new VertexBufferNode;
+        }
+        parent->_left  = const_cast< VertexBufferBase* >( _nodes[ left ] );
+        parent->_right = const_cast< VertexBufferBase* >( _nodes[ left + 1 ]);
+    }
+}
+
+void VertexBufferFlat::toStream( std::ostream& os ) const
+{
+    size_t length = _nNodes;
+    os.write( reinterpret_cast< char* >( &length ), sizeof( size_t ));
+    length = _nLeaves;
+    os.write( reinterpret_cast< char* >( &length ), sizeof( size_t ));
+
+    _write( os, _spheres, _nNodes );
+    _write( os, _ranges, _nNodes );
+    _write( os, _children, _nNodes );
+    _write( os, _boxes, _nLeaves );
+    _write( os, _vertexStarts, _nLeaves );
+    _write( os, _indexStarts, _nLeaves );
+    _write( os, _indexLengths, _nLeaves );
+    _write( os, _vertexLengths, _nLeaves );
+}
+
+void VertexBufferFlat::fromMemory( char** addr )
+{
+    clear();
+    memRead( reinterpret_cast< char* >( &_nNodes ), addr, sizeof( size_t ));
+    memRead( reinterpret_cast< char* >( &_nLeaves ), addr, sizeof( size_t ));
+
+    _spheres = _read< BoundingSphere >( addr, _nNodes );
+    _ranges = _read< Range >( addr, _nNodes );
+    _children = _read< uint32_t >( addr, _nNodes );
+    _boxes = _read< BoundingBox >( addr, _nLeaves );
+    _vertexStarts = _read< Index >( addr, _nLeaves );
+    _indexStarts = _read< Index >( addr, _nLeaves );
+    _indexLengths = _read< Index >( addr, _nLeaves );
+    _vertexLengths = _read< ShortIndex >( addr, _nLeaves );
+}
+
+void VertexBufferFlat::_setPointers()
+{
+    _spheres = _ptr( _sphereData );
+    _ranges = _ptr( _rangeData );
+    _children = _ptr( _childData );
+    _boxes = _ptr( _boxData );
+    _vertexStarts = _ptr( _vertexStartData );
+    _indexStarts = _ptr( _indexStartData );
+    _indexLengths = _ptr( _indexLengthData );
+    _vertexLengths = _ptr( _vertexLengthData );
+}
+
+}
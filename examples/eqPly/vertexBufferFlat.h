@@ -0,0 +1,120 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef MESH_VERTEXBUFFERFLAT_H
+#define MESH_VERTEXBUFFERFLAT_H
+
+
+#include "typedefs.h"
+#include <vector>
+#include <fstream>
+
+
+namespace mesh 
+{
+    // defined elsewhere
+    class VertexBufferBase;
+    class VertexBufferData;
+    class VertexBufferNode;
+
+    /*  The kd-tree in breadth-first order, one array per node attribute.
+
+        The two children of a node are stored next to each other, the root is
+        node zero. Leaf attributes are stored in separate arrays indexed by the
+        leaf number. The arrays either point into the memory-mapped binary file
+        or into storage owned by this object.  */
+    class VertexBufferFlat
+    {
+    public:
+        VertexBufferFlat() { clear(); }
+
+        void clear();
+
+        /*  Set up the arrays from the pointer-linked tree.  */
+        void setup( const VertexBufferNode* root );
+
+        /*  Create the pointer-linked tree below root from the arrays.  */
+        void createTree( VertexBufferNode* root, VertexBufferData& globalData );
+
+        /*  Write the arrays to the given stream.  */
+        void toStream( std::ostream& os ) const;
+
+        /*  Use the arrays at the given MMF address without copying them.  */
+        void fromMemory( char** addr );
+
+        size_t getNumNodes() const { return _nNodes; }
+
+        bool isLeaf( const size_t node ) const
+            { return ( _children[ node ] & LEAF_FLAG ) != 0; }
+        size_t getLeft( const size_t node ) const { return _children[ node ]; }
+        size_t getRight( const size_t node ) const
+            { return _children[ node ] + 1; }
+
+        const BoundingSphere& getBoundingSphere( const size_t node ) const
+            { return _spheres[ node ]; }
+        const Range& getRange( const size_t node ) const
+            { return _ranges[ node ]; }
+
+        /*  The tree node to draw for the given array index.  */
+        const VertexBufferBase* getNode( const size_t node ) const
+            { return _nodes[ node ]; }
+
+    private:
+        // marks leaves in the child array, the remaining bits are the leaf
+        static const uint32_t LEAF_FLAG = 0x80000000u;
+
+        size_t                  _nNodes;
+        size_t                  _nLeaves;
+        const BoundingSphere*   _spheres;
+        const Range*            _ranges;
+        const uint32_t*         _children;
+        const BoundingBox*      _boxes;
+        const Index*            _vertexStarts;
+        const Index*            _indexStarts;
+        const Index*            _indexLengths;
+        const ShortIndex*       _vertexLengths;
+
+        std::vector< const VertexBufferBase* > _nodes;
+
+        // storage if not set up from memory
+        std::vector< BoundingSphere >   _sphereData;
+        std::vector< Range >            _rangeData;
+        std::vector< uint32_t >         _childData;
+        std::vector< BoundingBox >      _boxData;
+        std::vector< Index >            _vertexStartData;
+        std::vector< Index >            _indexStartData;
+        std::vector< Index >            _indexLengthData;
+        std::vector< ShortIndex >       _vertexLengthData;
+
+        void _setPointers();
+    };
+}
+
+
+#endif // MESH_VERTEXBUFFERFLAT_H
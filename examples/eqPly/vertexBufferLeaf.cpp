@@ -32,47 +32,83 @@
 #include "vertexBufferData.h"
 #include "vertexBufferState.h"
 #include "vertexData.h"
-#include <map>
+#include <algorithm>
+#include <cmath>
 
 namespace mesh
 {
 
-/*  Finish partial setup - sort, reindex and merge into global data.  */
+/*  Finish partial setup - sort and assign the index range. The vertex data is
+    merged into the global data by collectVertices and writeData.  */
 void VertexBufferLeaf::setupTree( VertexData& data, const Index start,
                                   const Index length, const Axis axis,
                                   const size_t depth,
                                   VertexBufferData& globalData )
 {
     data.sort( start, length, axis );
-    _vertexStart = globalData.vertices.size();
+
+    // the leaves cover the triangles in order, three indices each
+    _vertexStart = 0;
     _vertexLength = 0;
-    _indexStart = globalData.indices.size();
-    _indexLength = 0;
+    _indexStart = start * 3;
+    _indexLength = length * 3;
+}
 
-    const bool hasColors = !data.colors.empty();
 
-    // stores the new indices (relative to _start)
-    std::map< Index, ShortIndex > newIndex;
+/*  Collect the sorted, unique vertices referenced by the leaf's triangles.  */
+void VertexBufferLeaf::collectVertices( const VertexData& data,
+                                        std::vector< Index >& vertices ) const
+{
+    const Index start = _indexStart / 3;
+    const Index end = start + _indexLength / 3;
+
+    vertices.clear();
+    vertices.reserve( _indexLength );
+    for( Index t = start; t < end; ++t )
+        for( Index v = 0; v < 3; ++v )
+            vertices.push_back( data.triangles[t][v] );
+
+    std::sort( vertices.begin(), vertices.end( ));
+    vertices.erase( std::unique( vertices.begin(), vertices.end( )),
+                    vertices.end( ));
+
+    // assert number of vertices does not exceed SmallIndex range
+    MESHASSERT( vertices.size() <= Index( ShortIndex( -1 )) + 1 );
+}
+
 
-    for( Index t = 0; t < length; ++t )
+/*  Reindex and write the leaf's data to its place in the global data, which
+    has to be sized already. */
+void VertexBufferLeaf::writeData( const VertexData& data,
+                                  const std::vector< Index >& vertices,
+                                  const Index vertexStart,
+                                  VertexBufferData& globalData )
+{
+    _vertexStart = vertexStart;
+    _vertexLength = ShortIndex( vertices.size( ));
+
+    const bool hasColors = !data.colors.empty();
+    for( Index i = 0; i < vertices.size(); ++i )
     {
+        const Index vertex = vertices[i];
+        globalData.vertices[ _vertexStart + i ] = data.vertices[ vertex ];
+        if( hasColors )
+            globalData.colors[ _vertexStart + i ] = data.colors[ vertex ];
+        globalData.normals[ _vertexStart + i ] = data.normals[ vertex ];
+    }
+
+    // the new indices are relative to _vertexStart
+    const Index start = _indexStart / 3;
+    const Index end = start + _indexLength / 3;
+    Index index = _indexStart;
+    for( Index t = start; t < end; ++t )
         for( Index v = 0; v < 3; ++v )
         {
-            Index i = data.triangles[start + t][v];
-            if( newIndex.find( i ) == newIndex.end() )
-            {
-                newIndex[i] = _vertexLength++;
-                // assert number of vertices does not exceed SmallIndex range
-                MESHASSERT( _vertexLength );
-                globalData.vertices.push_back( data.vertices[i] );
-                if( hasColors )
-                    globalData.colors.push_back( data.colors[i] );
-                globalData.normals.push_back( data.normals[i] );
-            }
-            globalData.indices.push_back( newIndex[i] );
-            ++_indexLength;
+            const Index vertex = data.triangles[t][v];
+            const std::vector< Index >::const_iterator i =
+                std::lower_bound( vertices.begin(), vertices.end(), vertex );
+            globalData.indices[ index++ ] = ShortIndex( i - vertices.begin( ));
         }
-    }
 
 #ifndef NDEBUG
     MESHINFO << "setupTree" << "( " << _indexStart << ", " << _indexLength
@@ -197,6 +233,39 @@ void VertexBufferLeaf::updateRange()
 #endif
 }
 
+namespace
+{
+/*  Quantize a normalized value in [-1,1] to a signed byte, using the GL 2.0
+    conversion rule f = ( 2c + 1 ) / 255 of normalized GL_BYTE attributes.  */
+inline GLbyte _toSNorm8( const float value )
+{
+    const float c = std::floor( ( value * 255.f - 1.f ) * .5f + .5f );
+    return GLbyte( std::min( 127.f, std::max( -128.f, c )));
+}
+
+inline float _signNotZero( const float value )
+{
+    return value >= 0.f ? 1.f : -1.f;
+}
+
+/*  Encode a unit normal into two bytes using the octahedral mapping.  */
+inline void _encodeNormal( const Normal& normal, GLbyte* encoded )
+{
+    const float length = std::fabs( normal[0] ) + std::fabs( normal[1] ) +
+                         std::fabs( normal[2] );
+    float x = length > 0.f ? normal[0] / length : 0.f;
+    float y = length > 0.f ? normal[1] / length : 0.f;
+    if( normal[2] < 0.f )
+    {
+        const float foldedX = ( 1.f - std::fabs( y )) * _signNotZero( x );
+        y = ( 1.f - std::fabs( x )) * _signNotZero( y );
+        x = foldedX;
+    }
+    encoded[0] = _toSNorm8( x );
+    encoded[1] = _toSNorm8( y );
+}
+}
+
 #define glewGetContext state.glewGetContext
 
 /*  Set up rendering of the leaf nodes.  */
@@ -275,6 +344,13 @@ void VertexBufferLeaf::draw( VertexBufferState& state ) const
       case RENDER_MODE_BUFFER_OBJECT:
           renderBufferObject( state );
           return;
+      case RENDER_MODE_PACKED_BUFFER_OBJECT:
+          renderPackedBufferObject( state );
+          return;
+      case RENDER_MODE_MULTI_DRAW:
+          // buffers are shared and bound by the root, just record the draw
+          state.getDrawBatch().add( _indexStart, _indexLength, _vertexStart );
+          return;
       case RENDER_MODE_DISPLAY_LIST:
       default:
           renderDisplayList( state );
@@ -310,6 +386,95 @@ void VertexBufferLeaf::renderBufferObject( VertexBufferState& state ) const
 }
 
 
+/*  Upload the packed vertex format of the leaf: positions as 3 x 16 bit
+    relative to the leaf bounding box and octahedral normals in 2 x 8 bit.  */
+void VertexBufferLeaf::setupPackedRendering( VertexBufferState& state,
+                                             GLuint* data ) const
+{
+    const char* charThis = reinterpret_cast< const char* >( this ) + 4;
+    const Vertex& origin = _boundingBox[0];
+    const Vertex extent = _boundingBox[1] - _boundingBox[0];
+
+    std::vector< GLushort > positions( _vertexLength * 3 );
+    std::vector< GLbyte > normals( _vertexLength * 2 );
+    for( Index i = 0; i < _vertexLength; ++i )
+    {
+        const Vertex& vertex = _globalData.vertices[ _vertexStart + i ];
+        for( size_t j = 0; j < 3; ++j )
+        {
+            const float value = extent[j] > 0.f ?
+                                ( vertex[j] - origin[j] ) / extent[j] : 0.f;
+            const float clamped = std::min( 1.f, std::max( 0.f, value ));
+            positions[ i * 3 + j ] = GLushort( clamped * 65535.f + .5f );
+        }
+        _encodeNormal( _globalData.normals[ _vertexStart + i ],
+                       &normals[ i * 2 ] );
+    }
+
+    if( data[VERTEX_OBJECT] == state.INVALID )
+        data[VERTEX_OBJECT] = state.newBufferObject( charThis + 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, data[VERTEX_OBJECT] );
+    glBufferData( GL_ARRAY_BUFFER, positions.size() * sizeof( GLushort ),
+                  &positions[0], GL_STATIC_DRAW );
+
+    if( data[NORMAL_OBJECT] == state.INVALID )
+        data[NORMAL_OBJECT] = state.newBufferObject( charThis + 1 );
+    glBindBuffer( GL_ARRAY_BUFFER, data[NORMAL_OBJECT] );
+    glBufferData( GL_ARRAY_BUFFER, normals.size() * sizeof( GLbyte ),
+                  &normals[0], GL_STATIC_DRAW );
+
+    if( data[COLOR_OBJECT] == state.INVALID )
+        data[COLOR_OBJECT] = state.newBufferObject( charThis + 2 );
+    if( state.useColors() )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, data[COLOR_OBJECT] );
+        glBufferData( GL_ARRAY_BUFFER, _vertexLength * sizeof( Color ),
+                      &_globalData.colors[_vertexStart], GL_STATIC_DRAW );
+    }
+
+    if( data[INDEX_OBJECT] == state.INVALID )
+        data[INDEX_OBJECT] = state.newBufferObject( charThis + 3 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, data[INDEX_OBJECT] );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, _indexLength * sizeof( ShortIndex ),
+                  &_globalData.indices[_indexStart], GL_STATIC_DRAW );
+}
+
+
+/*  Render the leaf with packed buffer objects, decoded by the packed vertex
+    shader bound in VertexBufferRoot::_beginRendering.  */
+void VertexBufferLeaf::renderPackedBufferObject( VertexBufferState& state )
+    const
+{
+    GLuint buffers[4];
+    for( int i = 0; i < 4; ++i )
+        buffers[i] = state.getBufferObject(
+            reinterpret_cast< const char* >( this ) + 4 + i );
+    if( buffers[VERTEX_OBJECT] == state.INVALID ||
+        buffers[NORMAL_OBJECT] == state.INVALID ||
+        buffers[COLOR_OBJECT] == state.INVALID ||
+        buffers[INDEX_OBJECT] == state.INVALID )
+
+        setupPackedRendering( state, buffers );
+
+    const Vertex extent = _boundingBox[1] - _boundingBox[0];
+    glVertexAttrib3fv( PACKED_ORIGIN_ATTRIBUTE, &_boundingBox[0][0] );
+    glVertexAttrib3fv( PACKED_SCALE_ATTRIBUTE, &extent[0] );
+
+    if( state.useColors() )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, buffers[COLOR_OBJECT] );
+        glColorPointer( 3, GL_UNSIGNED_BYTE, 0, 0 );
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, buffers[NORMAL_OBJECT] );
+    glVertexAttribPointer( PACKED_NORMAL_ATTRIBUTE, 2, GL_BYTE, GL_TRUE, 0, 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, buffers[VERTEX_OBJECT] );
+    glVertexAttribPointer( PACKED_POSITION_ATTRIBUTE, 3, GL_UNSIGNED_SHORT,
+                           GL_TRUE, 0, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, buffers[INDEX_OBJECT] );
+    glDrawElements( GL_TRIANGLES, GLsizei(_indexLength), GL_UNSIGNED_SHORT, 0 );
+}
+
+
 /*  Render the leaf with a display list.  */
 inline
 void VertexBufferLeaf::renderDisplayList( VertexBufferState& state ) const
@@ -343,40 +508,4 @@ void VertexBufferLeaf::renderImmediate( VertexBufferState& state ) const
     glEnd();
 }
 
-
-/*  Read leaf node from memory.  */
-void VertexBufferLeaf::fromMemory( char** addr, VertexBufferData& globalData )
-{
-    size_t nodeType;
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
-    if( nodeType != LEAF_TYPE )
-        throw MeshException( "Error reading binary file. Expected a leaf "
-                             "node, but found something else instead." );
-    VertexBufferBase::fromMemory( addr, globalData );
-    memRead( reinterpret_cast< char* >( &_boundingBox ), addr,
-             sizeof( BoundingBox ) );
-    memRead( reinterpret_cast< char* >( &_vertexStart ), addr,
-             sizeof( Index ) );
-    memRead( reinterpret_cast< char* >( &_vertexLength ), addr,
-             sizeof( ShortIndex ) );
-    memRead( reinterpret_cast< char* >( &_indexStart ), addr,
-             sizeof( Index ) );
-    memRead( reinterpret_cast< char* >( &_indexLength ), addr,
-             sizeof( Index ) );
-}
-
-
-/*  Write leaf node to output stream.  */
-void VertexBufferLeaf::toStream( std::ostream& os )
-{
-    size_t nodeType = LEAF_TYPE;
-    os.write( reinterpret_cast< char* >( &nodeType ), sizeof( size_t ));
-    VertexBufferBase::toStream( os );
-    os.write( reinterpret_cast< char* >( &_boundingBox ), sizeof( BoundingBox));
-    os.write( reinterpret_cast< char* >( &_vertexStart ), sizeof( Index ));
-    os.write( reinterpret_cast< char* >( &_vertexLength ),sizeof( ShortIndex ));
-    os.write( reinterpret_cast< char* >( &_indexStart ), sizeof( Index ));
-    os.write( reinterpret_cast< char* >( &_indexLength ), sizeof( Index ));
-}
-
 }
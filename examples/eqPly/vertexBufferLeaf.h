@@ -36,6 +36,7 @@
 
 
 #include "vertexBufferBase.h"
+#include <vector>
 
 
 namespace mesh 
@@ -53,21 +54,27 @@ namespace mesh
         virtual Index getNumberOfVertices() const { return _indexLength; }
         
     protected:
-        virtual void toStream( std::ostream& os );
-        virtual void fromMemory( char** addr, VertexBufferData& globalData );
-        
         virtual void setupTree( VertexData& data, const Index start,
                                 const Index length, const Axis axis,
                                 const size_t depth,
                                 VertexBufferData& globalData );
         virtual const BoundingSphere& updateBoundingSphere();
         virtual void updateRange();
+
+        void collectVertices( const VertexData& data,
+                              std::vector< Index >& vertices ) const;
+        void writeData( const VertexData& data,
+                        const std::vector< Index >& vertices,
+                        const Index vertexStart, VertexBufferData& globalData );
         
     private:
         void setupRendering( VertexBufferState& state, GLuint* data ) const;
         void renderImmediate( VertexBufferState& state ) const;
         void renderDisplayList( VertexBufferState& state ) const;
         void renderBufferObject( VertexBufferState& state ) const;
+        void setupPackedRendering( VertexBufferState& state,
+                                   GLuint* data ) const;
+        void renderPackedBufferObject( VertexBufferState& state ) const;
         
         VertexBufferData&   _globalData;
         BoundingBox         _boundingBox;
@@ -76,6 +83,8 @@ namespace mesh
         Index               _indexLength;
         ShortIndex          _vertexLength;
         friend class eqPly::VertexBufferDist;
+        friend class VertexBufferFlat;
+        friend class VertexBufferRoot;
     };
     
     
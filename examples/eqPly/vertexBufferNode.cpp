@@ -56,6 +56,27 @@ void VertexBufferNode::setupTree( VertexData& data, const Index start,
                                   const Index length, const Axis axis,
                                   const size_t depth,
                                   VertexBufferData& globalData )
+{
+    Subtree left, right;
+    setupChildren( data, start, length, axis, depth, globalData, left, right );
+
+    // continue contruction in the child nodes
+    static_cast< VertexBufferNode* >
+            ( _left )->setupTree( data, left.start, left.length, left.axis,
+                                  left.depth, globalData );
+    static_cast< VertexBufferNode* >
+        ( _right )->setupTree( data, right.start, right.length, right.axis,
+                               right.depth, globalData );
+}
+
+
+/*  Split the data at the median and create the children, without setting
+    them up.  */
+void VertexBufferNode::setupChildren( VertexData& data, const Index start,
+                                      const Index length, const Axis axis,
+                                      const size_t depth,
+                                      VertexBufferData& globalData,
+                                      Subtree& left, Subtree& right )
 {
 #ifndef NDEBUG
     MESHINFO << "setupTree"
@@ -67,37 +88,34 @@ void VertexBufferNode::setupTree( VertexData& data, const Index start,
     const Index median = start + ( length / 2 );
 
     // left child will include elements smaller than the median
-    const Index leftLength    = length / 2;
-    const bool  subdivideLeft = _subdivide( leftLength, depth );
+    left.start  = start;
+    left.length = length / 2;
+    left.depth  = depth + 1;
+    left.isLeaf = !_subdivide( left.length, depth );
 
-    if( subdivideLeft )
-        _left = new VertexBufferNode;
-    else
+    if( left.isLeaf )
         _left = new VertexBufferLeaf( globalData );
+    else
+        _left = new VertexBufferNode;
+    left.node = _left;
     
     // right child will include elements equal to or greater than the median
-    const Index rightLength    = ( length + 1 ) / 2;
-    const bool  subdivideRight = _subdivide( rightLength, depth );
+    right.start  = median;
+    right.length = ( length + 1 ) / 2;
+    right.depth  = depth + 1;
+    right.isLeaf = !_subdivide( right.length, depth );
 
-    if( subdivideRight )
-        _right = new VertexBufferNode;
-    else
+    if( right.isLeaf )
         _right = new VertexBufferLeaf( globalData );
+    else
+        _right = new VertexBufferNode;
+    right.node = _right;
     
-    // move to next axis and continue contruction in the child nodes
-    const Axis newAxisLeft  = subdivideLeft ? 
-                        data.getLongestAxis( start , leftLength  ) : AXIS_X;
-
-    const Axis newAxisRight = subdivideRight ? 
-                        data.getLongestAxis( median, rightLength ) : AXIS_X;
-
-    static_cast< VertexBufferNode* >
-            ( _left )->setupTree( data, start, leftLength, newAxisLeft, depth+1,
-                                  globalData );
-    static_cast< VertexBufferNode* >
-        ( _right )->setupTree( data, median, rightLength, newAxisRight, depth+1,
-                               globalData );
-
+    // move to next axis
+    left.axis  = left.isLeaf ? AXIS_X :
+                               data.getLongestAxis( start, left.length );
+    right.axis = right.isLeaf ? AXIS_X :
+                                data.getLongestAxis( median, right.length );
 }
 
 
@@ -160,52 +178,4 @@ void VertexBufferNode::draw( VertexBufferState& state ) const
     _right->draw( state );
 }
 
-
-/*  Read node from memory and continue with remaining nodes.  */
-void VertexBufferNode::fromMemory( char** addr, VertexBufferData& globalData )
-{
-    // read node itself   
-    size_t nodeType;
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
-    if( nodeType != NODE_TYPE )
-        throw MeshException( "Error reading binary file. Expected a regular "
-                             "node, but found something else instead." );
-    VertexBufferBase::fromMemory( addr, globalData );
-    
-    // read left child (peek ahead)
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
-    if( nodeType != NODE_TYPE && nodeType != LEAF_TYPE )
-        throw MeshException( "Error reading binary file. Expected either a "
-                             "regular or a leaf node, but found neither." );
-    *addr -= sizeof( size_t );
-    if( nodeType == NODE_TYPE )
-        _left = new VertexBufferNode;
-    else
-        _left = new VertexBufferLeaf( globalData );
-    static_cast< VertexBufferNode* >( _left )->fromMemory( addr, globalData );
-    
-    // read right child (peek ahead)
-    memRead( reinterpret_cast< char* >( &nodeType ), addr, sizeof( size_t ) );
-    if( nodeType != NODE_TYPE && nodeType != LEAF_TYPE )
-        throw MeshException( "Error reading binary file. Expected either a "
-                             "regular or a leaf node, but found neither." );
-    *addr -= sizeof( size_t );
-    if( nodeType == NODE_TYPE )
-        _right = new VertexBufferNode;
-    else
-        _right = new VertexBufferLeaf( globalData );
-    static_cast< VertexBufferNode* >( _right )->fromMemory( addr, globalData );
-}
-
-
-/*  Write node to output stream and continue with remaining nodes.  */
-void VertexBufferNode::toStream( std::ostream& os )
-{
-    size_t nodeType = NODE_TYPE;
-    os.write( reinterpret_cast< char* >( &nodeType ), sizeof( size_t ) );
-    VertexBufferBase::toStream( os );
-    static_cast< VertexBufferNode* >( _left )->toStream( os );
-    static_cast< VertexBufferNode* >( _right )->toStream( os );
-}
-
 }
@@ -54,13 +54,25 @@ namespace mesh
         virtual const VertexBufferBase* getRight() const { return _right; }
 
     protected:
-        virtual void toStream( std::ostream& os );
-        virtual void fromMemory( char** addr, VertexBufferData& globalData );
+        /*  The parameters to set up one child subtree.  */
+        struct Subtree
+        {
+            VertexBufferBase*   node;
+            Index               start;
+            Index               length;
+            Axis                axis;
+            size_t              depth;
+            bool                isLeaf;
+        };
 
         virtual void setupTree( VertexData& data, const Index start,
                                 const Index length, const Axis axis,
                                 const size_t depth, 
                                 VertexBufferData& globalData );
+        void setupChildren( VertexData& data, const Index start,
+                            const Index length, const Axis axis,
+                            const size_t depth, VertexBufferData& globalData,
+                            Subtree& left, Subtree& right );
         virtual const BoundingSphere& updateBoundingSphere();
         virtual void updateRange();
 
@@ -68,6 +80,8 @@ namespace mesh
         VertexBufferBase*   _left;
         VertexBufferBase*   _right;
         friend class eqPly::VertexBufferDist;
+        friend class VertexBufferFlat;
+        friend class VertexBufferRoot;
     };
 }
 
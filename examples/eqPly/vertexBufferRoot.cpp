@@ -29,6 +29,7 @@
 
 
 #include "vertexBufferRoot.h"
+#include "vertexBufferLeaf.h"
 #include "vertexBufferState.h"
 #include "vertexData.h"
 #include <string>
@@ -52,18 +53,118 @@ bool isArchitectureLittleEndian();
 /*  Construct architecture dependent file name.  */
 std::string getArchitectureFilename( const std::string& filename );
 
+/*  Destructor, releases the binary file used by the flat tree.  */
+VertexBufferRoot::~VertexBufferRoot()
+{
+    _flat.clear();
+    _unmap();
+}
+
+namespace
+{
+typedef std::vector< VertexBufferLeaf* > Leaves;
+
+/*  The number of subtrees set up in parallel.  */
+static const size_t _nSetupSubtrees = 64;
+
+/*  Collect the leaves below the given node, in ascending index order.  */
+void _collectLeaves( const VertexBufferBase* node, Leaves& leaves )
+{
+    if( node->getLeft() && node->getRight( ))
+    {
+        _collectLeaves( node->getLeft(), leaves );
+        _collectLeaves( node->getRight(), leaves );
+        return;
+    }
+    const VertexBufferLeaf* leaf = 
+        static_cast< const VertexBufferLeaf* >( node );
+    leaves.push_back( const_cast< VertexBufferLeaf* >( leaf ));
+}
+}
+
 /*  Begin kd-tree setup, go through full range starting with x axis.  */
 void VertexBufferRoot::setupTree( VertexData& data )
 {
     // data is VertexData, _data is VertexBufferData
     _data.clear();
 
-    const Axis axis = data.getLongestAxis( 0, data.triangles.size() );
+    const Index nTriangles = data.triangles.size();
+    const Axis axis = data.getLongestAxis( 0, nTriangles );
+
+    // 1) split the top levels breadth-first into independent subtrees
+    Subtree left, right;
+    setupChildren( data, 0, nTriangles, axis, 0, _data, left, right );
+
+    std::vector< Subtree > subtrees;
+    subtrees.push_back( left );
+    subtrees.push_back( right );
+
+    bool split = true;
+    while( split && subtrees.size() < _nSetupSubtrees )
+    {
+        split = false;
+        std::vector< Subtree > next;
+        for( std::vector< Subtree >::const_iterator i = subtrees.begin();
+             i != subtrees.end(); ++i )
+        {
+            if( i->isLeaf )
+            {
+                next.push_back( *i );
+                continue;
+            }
+            static_cast< VertexBufferNode* >( i->node )->setupChildren( data,
+                i->start, i->length, i->axis, i->depth, _data, left, right );
+            next.push_back( left );
+            next.push_back( right );
+            split = true;
+        }
+        subtrees.swap( next );
+    }
+
+    // 2) set up the subtrees in parallel, each sorts its own triangle range
+#pragma omp parallel for schedule( dynamic )
+    for( ssize_t i = 0; i < ssize_t( subtrees.size( )); ++i )
+    {
+        const Subtree& subtree = subtrees[i];
+        static_cast< VertexBufferNode* >( subtree.node )->setupTree( data,
+            subtree.start, subtree.length, subtree.axis, subtree.depth, _data );
+    }
+
+    // 3) collect the vertices of each leaf in parallel
+    Leaves leaves;
+    _collectLeaves( this, leaves );
+
+    std::vector< std::vector< Index > > vertices( leaves.size( ));
+#pragma omp parallel for schedule( dynamic )
+    for( ssize_t i = 0; i < ssize_t( leaves.size( )); ++i )
+        leaves[i]->collectVertices( data, vertices[i] );
+
+    // 4) place the leaves' vertices one after another, in tree order
+    std::vector< Index > vertexStarts( leaves.size( ));
+    Index nVertices = 0;
+    for( size_t i = 0; i < leaves.size(); ++i )
+    {
+        vertexStarts[i] = nVertices;
+        nVertices += vertices[i].size();
+    }
+
+    _data.vertices.resize( nVertices );
+    if( !data.colors.empty( ))
+        _data.colors.resize( nVertices );
+    _data.normals.resize( nVertices );
+    _data.indices.resize( nTriangles * 3 );
+
+    // 5) reindex and write the leaves' data in parallel
+#pragma omp parallel for schedule( dynamic )
+    for( ssize_t i = 0; i < ssize_t( leaves.size( )); ++i )
+    {
+        leaves[i]->writeData( data, vertices[i], vertexStarts[i], _data );
+        std::vector< Index >().swap( vertices[i] );
+    }
 
-    VertexBufferNode::setupTree( data, 0, data.triangles.size(), 
-                                 axis, 0, _data );
     VertexBufferNode::updateBoundingSphere();
     VertexBufferNode::updateRange();
+    _flat.setup( this );
 
 #if 0
     // re-test all points to be in the bounding sphere
@@ -82,84 +183,60 @@ void VertexBufferRoot::setupTree( VertexData& data )
 #endif
 }
 
-// #define LOGCULL
-void VertexBufferRoot::cullDraw( VertexBufferState& state ) const
+namespace
 {
-    _beginRendering( state );
-    
-#ifdef LOGCULL
-    size_t verticesRendered = 0;
-    size_t verticesOverlap  = 0;
-#endif
+typedef std::vector< const VertexBufferBase* > Nodes;
+typedef std::vector< size_t > Indices;
 
-    const Range& range = state.getRange();
-    FrustumCuller culler;
-    culler.setup( state.getProjectionModelViewMatrix( ));
+/*  The number of subtrees culled in parallel.  */
+static const size_t _nSubtrees = 64;
 
-    // start with root node
-    std::vector< const mesh::VertexBufferBase* > candidates;
-    candidates.push_back( this );
+/*  Collect the nodes of one subtree to draw, in ascending range order.  */
+void _cullSubtree( const VertexBufferFlat& tree, const size_t root,
+                   const FrustumCuller& culler, const Range& range,
+                   const bool useFrustumCulling, Nodes& visible )
+{
+    Indices candidates;
+    candidates.push_back( root );
 
     while( !candidates.empty() )
     {
-        if( state.stopRendering( ))
-            return;
-
-        const mesh::VertexBufferBase* treeNode = candidates.back();
+        const size_t treeNode = candidates.back();
         candidates.pop_back();
-            
+
         // completely out of range check
-        if( treeNode->getRange()[0] >= range[1] ||
-            treeNode->getRange()[1] < range[0] )
-        {
+        const Range& nodeRange = tree.getRange( treeNode );
+        if( nodeRange[0] >= range[1] || nodeRange[1] < range[0] )
             continue;
-        }
 
         // bounding sphere view frustum culling
-        const vmml::Visibility visibility = state.useFrustumCulling() ?
-                            culler.test_sphere( treeNode->getBoundingSphere( )) :
-                            vmml::VISIBILITY_FULL;
+        const vmml::Visibility visibility = useFrustumCulling ?
+                    culler.test_sphere( tree.getBoundingSphere( treeNode )) :
+                    vmml::VISIBILITY_FULL;
         switch( visibility )
         {
             case vmml::VISIBILITY_FULL:
                 // if fully visible and fully in range, render it
-                if( treeNode->getRange()[0] >= range[0] && 
-                    treeNode->getRange()[1] <  range[1] )
+                if( nodeRange[0] >= range[0] && nodeRange[1] < range[1] )
                 {
-                    treeNode->draw( state );
-                    //treeNode->drawBoundingSphere( state );
-#ifdef LOGCULL
-                    verticesRendered += treeNode->getNumberOfVertices();
-#endif
+                    visible.push_back( tree.getNode( treeNode ));
                     break;
                 }
                 // partial range, fall through to partial visibility
 
             case vmml::VISIBILITY_PARTIAL:
             {
-                const mesh::VertexBufferBase* left  = treeNode->getLeft();
-                const mesh::VertexBufferBase* right = treeNode->getRight();
-            
-                if( !left && !right )
+                if( tree.isLeaf( treeNode ))
                 {
-                    if( treeNode->getRange()[0] >= range[0] )
-                    {
-                        treeNode->draw( state );
-                        //treeNode->drawBoundingSphere( state );
-#ifdef LOGCULL
-                        verticesRendered += treeNode->getNumberOfVertices();
-                        if( visibility == vmml::VISIBILITY_PARTIAL )
-                            verticesOverlap  += treeNode->getNumberOfVertices();
-#endif
-                    }
+                    if( nodeRange[0] >= range[0] )
+                        visible.push_back( tree.getNode( treeNode ));
                     // else drop, to be drawn by 'previous' channel
                 }
                 else
                 {
-                    if( left )
-                        candidates.push_back( left );
-                    if( right )
-                        candidates.push_back( right );
+                    // right first, so that left is processed first
+                    candidates.push_back( tree.getRight( treeNode ));
+                    candidates.push_back( tree.getLeft( treeNode ));
                 }
                 break;
             }
@@ -168,19 +245,162 @@ void VertexBufferRoot::cullDraw( VertexBufferState& state ) const
                 break;
         }
     }
+}
+
+/*  Split the tree into up to _nSubtrees subtrees, in ascending range order.  */
+void _split( const VertexBufferFlat& tree, Indices& subtrees )
+{
+    subtrees.push_back( 0 );
+
+    bool split = true;
+    while( split && subtrees.size() < _nSubtrees )
+    {
+        split = false;
+        Indices next;
+        next.reserve( subtrees.size() * 2 );
+        for( Indices::const_iterator i = subtrees.begin(); i != subtrees.end();
+             ++i )
+        {
+            if( tree.isLeaf( *i ))
+            {
+                next.push_back( *i );
+                continue;
+            }
+            next.push_back( tree.getLeft( *i ));
+            next.push_back( tree.getRight( *i ));
+            split = true;
+        }
+        subtrees.swap( next );
+    }
+}
+
+bool _isValid( const CullResult& result, const Matrix4f& pmvMatrix,
+               const Range& range, const bool useFrustumCulling )
+{
+    return result.valid && result.pmvMatrix == pmvMatrix &&
+           result.range[0] == range[0] && result.range[1] == range[1] &&
+           result.frustumCulling == useFrustumCulling;
+}
+}
+
+/*  Collect the nodes to draw, culling the subtrees of the root in parallel.
+    The result is kept in the state and reused while the view is unchanged. */
+const std::vector< const VertexBufferBase* >&
+VertexBufferRoot::_cull( VertexBufferState& state ) const
+{
+    const Matrix4f& pmvMatrix = state.getProjectionModelViewMatrix();
+    const Range& range = state.getRange();
+    const bool useFrustumCulling = state.useFrustumCulling();
+
+    CullResult& result = state.getCullResult( this );
+    if( _isValid( result, pmvMatrix, range, useFrustumCulling ))
+        return result.nodes;
+
+    FrustumCuller culler;
+    culler.setup( pmvMatrix );
+
+    Indices subtrees;
+    if( _flat.getNumNodes() > 0 )
+        _split( _flat, subtrees );
+
+    std::vector< Nodes > visible( subtrees.size( ));
+#pragma omp parallel for schedule( dynamic )
+    for( ssize_t i = 0; i < ssize_t( subtrees.size( )); ++i )
+        _cullSubtree( _flat, subtrees[i], culler, range, useFrustumCulling,
+                      visible[i] );
+
+    result.nodes.clear();
+    for( std::vector< Nodes >::const_iterator i = visible.begin();
+         i != visible.end(); ++i )
+    {
+        result.nodes.insert( result.nodes.end(), i->begin(), i->end( ));
+    }
+
+    result.pmvMatrix = pmvMatrix;
+    result.range = range;
+    result.frustumCulling = useFrustumCulling;
+    result.valid = true;
+    return result.nodes;
+}
+
+// #define LOGCULL
+void VertexBufferRoot::cullDraw( VertexBufferState& state ) const
+{
+    const Nodes& visible = _cull( state );
+
+    _beginRendering( state );
+    
+#ifdef LOGCULL
+    size_t verticesRendered = 0;
+#endif
+
+    for( Nodes::const_iterator i = visible.begin(); i != visible.end(); ++i )
+    {
+        if( state.stopRendering( ))
+            break;
+
+        (*i)->draw( state );
+        //(*i)->drawBoundingSphere( state );
+#ifdef LOGCULL
+        verticesRendered += (*i)->getNumberOfVertices();
+#endif
+    }
     
     _endRendering( state );
 
 #ifdef LOGCULL
-    const size_t verticesTotal = model->getNumberOfVertices();
+    const size_t verticesTotal = getNumberOfVertices();
     MESHINFO
         << getName() << " rendered " << verticesRendered * 100 / verticesTotal
-        << "% of model, overlap <= " << verticesOverlap * 100 / verticesTotal
-        << "%" << std::endl;
+        << "% of model" << std::endl;
 #endif    
 }
 
 
+#define glewGetContext state.glewGetContext
+
+/*  Upload the whole model into one buffer per attribute, shared by all leaves
+    in multi-draw mode. Leaf indices stay 16 bit, each leaf draw supplies its
+    vertex start as base vertex.  */
+void VertexBufferRoot::_setupSharedBuffers( VertexBufferState& state,
+                                            GLuint* buffers ) const
+{
+    const char* charThis = reinterpret_cast< const char* >( this );
+    for( int i = 0; i < 4; ++i )
+        buffers[i] = state.getBufferObject( charThis + i );
+
+    if( buffers[VERTEX_OBJECT] == state.INVALID )
+    {
+        buffers[VERTEX_OBJECT] = state.newBufferObject( charThis + 0 );
+        glBindBuffer( GL_ARRAY_BUFFER, buffers[VERTEX_OBJECT] );
+        glBufferData( GL_ARRAY_BUFFER, _data.vertices.size() * sizeof( Vertex ),
+                      &_data.vertices[0], GL_STATIC_DRAW );
+    }
+    if( buffers[NORMAL_OBJECT] == state.INVALID )
+    {
+        buffers[NORMAL_OBJECT] = state.newBufferObject( charThis + 1 );
+        glBindBuffer( GL_ARRAY_BUFFER, buffers[NORMAL_OBJECT] );
+        glBufferData( GL_ARRAY_BUFFER, _data.normals.size() * sizeof( Normal ),
+                      &_data.normals[0], GL_STATIC_DRAW );
+    }
+    if( buffers[COLOR_OBJECT] == state.INVALID && state.useColors() )
+    {
+        buffers[COLOR_OBJECT] = state.newBufferObject( charThis + 2 );
+        glBindBuffer( GL_ARRAY_BUFFER, buffers[COLOR_OBJECT] );
+        glBufferData( GL_ARRAY_BUFFER, _data.colors.size() * sizeof( Color ),
+                      &_data.colors[0], GL_STATIC_DRAW );
+    }
+    if( buffers[INDEX_OBJECT] == state.INVALID )
+    {
+        buffers[INDEX_OBJECT] = state.newBufferObject( charThis + 3 );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, buffers[INDEX_OBJECT] );
+        glBufferData( GL_ELEMENT_ARRAY_BUFFER,
+                      _data.indices.size() * sizeof( ShortIndex ),
+                      &_data.indices[0], GL_STATIC_DRAW );
+    }
+}
+
+
 /*  Set up the common OpenGL state for rendering of all nodes.  */
 void VertexBufferRoot::_beginRendering( VertexBufferState& state ) const
 {
@@ -194,6 +414,41 @@ void VertexBufferRoot::_beginRendering( VertexBufferState& state ) const
         glEnableClientState( GL_NORMAL_ARRAY );
         if( state.useColors() )
             glEnableClientState( GL_COLOR_ARRAY );
+        break;
+
+    case RENDER_MODE_PACKED_BUFFER_OBJECT:
+    {
+        glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+        glUseProgram( state.getPackedProgram( ));
+        glEnableVertexAttribArray( PACKED_POSITION_ATTRIBUTE );
+        glEnableVertexAttribArray( PACKED_NORMAL_ATTRIBUTE );
+        if( state.useColors() )
+            glEnableClientState( GL_COLOR_ARRAY );
+        break;
+    }
+
+    case RENDER_MODE_MULTI_DRAW:
+    {
+        GLuint buffers[4];
+        _setupSharedBuffers( state, buffers );
+
+        glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+        glEnableClientState( GL_VERTEX_ARRAY );
+        glEnableClientState( GL_NORMAL_ARRAY );
+        if( state.useColors() )
+        {
+            glEnableClientState( GL_COLOR_ARRAY );
+            glBindBuffer( GL_ARRAY_BUFFER, buffers[COLOR_OBJECT] );
+            glColorPointer( 3, GL_UNSIGNED_BYTE, 0, 0 );
+        }
+        glBindBuffer( GL_ARRAY_BUFFER, buffers[NORMAL_OBJECT] );
+        glNormalPointer( GL_FLOAT, 0, 0 );
+        glBindBuffer( GL_ARRAY_BUFFER, buffers[VERTEX_OBJECT] );
+        glVertexPointer( 3, GL_FLOAT, 0, 0 );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, buffers[INDEX_OBJECT] );
+        state.getDrawBatch().clear();
+        break;
+    }
 #endif
     case RENDER_MODE_DISPLAY_LIST:
     case RENDER_MODE_IMMEDIATE:
@@ -219,10 +474,39 @@ void VertexBufferRoot::_endRendering( VertexBufferState& state ) const
     case RENDER_MODE_BUFFER_OBJECT:
     {
         // deactivate VBO and EBO use
-#define glewGetContext state.glewGetContext
         glBindBuffer( GL_ARRAY_BUFFER_ARB, 0);
         glBindBuffer( GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
         glPopClientAttrib();
+        break;
+    }
+
+    case RENDER_MODE_PACKED_BUFFER_OBJECT:
+    {
+        glDisableVertexAttribArray( PACKED_POSITION_ATTRIBUTE );
+        glDisableVertexAttribArray( PACKED_NORMAL_ATTRIBUTE );
+        glBindBuffer( GL_ARRAY_BUFFER_ARB, 0);
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+        glPopClientAttrib();
+        glUseProgram( 0 );
+        break;
+    }
+
+    case RENDER_MODE_MULTI_DRAW:
+    {
+        // submit all leaf draws collected during traversal at once
+        DrawBatch& batch = state.getDrawBatch();
+        if( !batch.counts.empty( ))
+            glMultiDrawElementsBaseVertex( GL_TRIANGLES, &batch.counts[0],
+                                           GL_UNSIGNED_SHORT,
+                                           &batch.offsets[0],
+                                           GLsizei( batch.counts.size( )),
+                                           &batch.baseVertices[0] );
+        batch.clear();
+
+        glBindBuffer( GL_ARRAY_BUFFER_ARB, 0);
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+        glPopClientAttrib();
+        break;
     }
 #endif
     case RENDER_MODE_DISPLAY_LIST:
@@ -327,7 +611,18 @@ bool VertexBufferRoot::_readBinary( std::string filename )
             MESHERROR << "Unable to read binary file, an exception occured:  "
                       << e.what() << std::endl;
         }
-        UnmapViewOfFile( addr );
+
+        // keep the view, the flat tree uses it directly
+        if( result )
+        {
+            _unmap();
+            _map = addr;
+        }
+        else
+        {
+            _flat.clear();
+            UnmapViewOfFile( addr );
+        }
     }
     else
     {
@@ -365,7 +660,19 @@ bool VertexBufferRoot::_readBinary( std::string filename )
             MESHERROR << "Unable to read binary file, an exception occured:  "
                       << e.what() << std::endl;
         }
-        munmap( addr, status.st_size );
+
+        // keep the mapping, the flat tree uses it directly
+        if( result )
+        {
+            _unmap();
+            _map = addr;
+            _mapSize = status.st_size;
+        }
+        else
+        {
+            _flat.clear();
+            munmap( addr, status.st_size );
+        }
     }
     else
     {
@@ -378,6 +685,21 @@ bool VertexBufferRoot::_readBinary( std::string filename )
 #endif
 }
 
+/*  Release the binary file mapping.  */
+void VertexBufferRoot::_unmap()
+{
+    if( !_map )
+        return;
+
+#ifdef WIN32
+    UnmapViewOfFile( _map );
+#else
+    munmap( _map, _mapSize );
+#endif
+    _map = 0;
+    _mapSize = 0;
+}
+
 /*  Read binary kd-tree representation, construct from ply if unavailable.  */
 bool VertexBufferRoot::readFromFile( const std::string& filename )
 {
@@ -426,7 +748,8 @@ bool VertexBufferRoot::writeToFile( const std::string& filename )
 }
 
 
-/*  Read root node from memory and continue with other nodes.  */
+/*  Read root node from memory and create the other nodes from the flat
+    tree, which uses the memory directly.  */
 void VertexBufferRoot::fromMemory( char* start )
 {
     char** addr = &start;
@@ -441,11 +764,12 @@ void VertexBufferRoot::fromMemory( char* start )
         throw MeshException( "Error reading binary file. Expected the root "
                              "node, but found something else instead." );
     _data.fromMemory( addr );
-    VertexBufferNode::fromMemory( addr, _data );
+    _flat.fromMemory( addr );
+    _flat.createTree( this, _data );
 }
 
 
-/*  Write root node to output stream and continue with other nodes.  */
+/*  Write root node to output stream, followed by the flat tree.  */
 void VertexBufferRoot::toStream( std:: ostream& os )
 {
     size_t version = FILE_VERSION;
@@ -453,7 +777,7 @@ void VertexBufferRoot::toStream( std:: ostream& os )
     size_t nodeType = ROOT_TYPE;
     os.write( reinterpret_cast< char* >( &nodeType ), sizeof( size_t ) );
     _data.toStream( os );
-    VertexBufferNode::toStream( os );
+    _flat.toStream( os );
 }
 
 }
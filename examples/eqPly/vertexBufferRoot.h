@@ -33,6 +33,7 @@
 
 #include "vertexBufferNode.h"
 #include "vertexBufferData.h"
+#include "vertexBufferFlat.h"
 
 namespace mesh
 {
@@ -40,7 +41,9 @@ namespace mesh
     class VertexBufferRoot : public VertexBufferNode
     {
     public:
-        VertexBufferRoot() : VertexBufferNode(), _invertFaces(false) {}
+        VertexBufferRoot() : VertexBufferNode(), _invertFaces(false), _map(0),
+                             _mapSize(0) {}
+        virtual ~VertexBufferRoot();
 
         virtual void cullDraw( VertexBufferState& state ) const;
         virtual void draw( VertexBufferState& state ) const;
@@ -61,13 +64,21 @@ namespace mesh
     private:
         bool _constructFromPly( const std::string& filename );
         bool _readBinary( std::string filename );
+        void _unmap();
 
+        const std::vector< const VertexBufferBase* >&
+        _cull( VertexBufferState& state ) const;
         void _beginRendering( VertexBufferState& state ) const;
         void _endRendering( VertexBufferState& state ) const;
+        void _setupSharedBuffers( VertexBufferState& state,
+                                  GLuint* buffers ) const;
 
         VertexBufferData _data;
+        VertexBufferFlat _flat;
         bool             _invertFaces;
         std::string      _name;
+        char*            _map;     // binary file, used by _flat
+        size_t           _mapSize;
 
         friend class eqPly::VertexBufferDist;
     };
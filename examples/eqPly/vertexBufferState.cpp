@@ -35,6 +35,7 @@ VertexBufferState::VertexBufferState( const GLEWContext* glewContext )
         : _pmvMatrix( Matrix4f::IDENTITY )
         , _glewContext( glewContext )
         , _renderMode( RENDER_MODE_DISPLAY_LIST )
+        , _packedProgram( INVALID )
         , _useColors( false )
         , _useFrustumCulling( true )
 {
@@ -51,6 +52,24 @@ void VertexBufferState::setRenderMode( const RenderMode mode )
 
     _renderMode = mode;
 
+    // Multi-draw submits each leaf with its own base vertex
+    if( _renderMode == RENDER_MODE_MULTI_DRAW &&
+        !GLEW_VERSION_3_2 && !GLEW_ARB_draw_elements_base_vertex )
+    {
+        MESHINFO << "glMultiDrawElementsBaseVertex not available, using VBOs"
+                 << std::endl;
+        _renderMode = RENDER_MODE_BUFFER_OBJECT;
+    }
+
+    // The packed format needs its decoding shader, else use plain VBOs
+    if( _renderMode == RENDER_MODE_PACKED_BUFFER_OBJECT &&
+        ( !GLEW_VERSION_2_0 || _packedProgram == INVALID ))
+    {
+        MESHINFO << "Packed vertex shader not available, using VBOs"
+                 << std::endl;
+        _renderMode = RENDER_MODE_BUFFER_OBJECT;
+    }
+
     // Check if VBO funcs available, else fall back to display lists
     if( _renderMode == RENDER_MODE_BUFFER_OBJECT && !GLEW_VERSION_1_5 )
     {
@@ -33,6 +33,7 @@
 
 #include "typedefs.h"
 #include <map>
+#include <vector>
 
 #ifdef EQUALIZER
 #  include <eq/eq.h>
@@ -41,6 +42,44 @@
 
 namespace mesh 
 {
+    class VertexBufferBase;
+
+    /*  The nodes to draw of one model, valid for the given cull parameters. */
+    struct CullResult
+    {
+        CullResult() : frustumCulling( false ), valid( false ) {}
+
+        Matrix4f pmvMatrix;
+        Range    range;
+        bool     frustumCulling;
+        bool     valid;
+        std::vector< const VertexBufferBase* > nodes;
+    };
+
+    /*  The leaf draws of one frame, submitted with one multi-draw call.  */
+    struct DrawBatch
+    {
+        void add( const Index indexStart, const Index indexLength,
+                  const Index vertexStart )
+        {
+            counts.push_back( GLsizei( indexLength ));
+            offsets.push_back( reinterpret_cast< GLvoid* >(
+                                   indexStart * sizeof( ShortIndex )));
+            baseVertices.push_back( GLint( vertexStart ));
+        }
+
+        void clear()
+        {
+            counts.clear();
+            offsets.clear();
+            baseVertices.clear();
+        }
+
+        std::vector< GLsizei > counts;
+        std::vector< GLvoid* > offsets;
+        std::vector< GLint >   baseVertices;
+    };
+
     /*  The abstract base class for kd-tree rendering state.  */
     class VertexBufferState
     {
@@ -79,6 +118,18 @@ namespace mesh
         virtual void deleteAll() = 0;
 
         const GLEWContext* glewGetContext() const { return _glewContext; }
+
+        /*  The shader program decoding the packed vertex format.  */
+        void setPackedProgram( const GLuint program )
+            { _packedProgram = program; }
+        GLuint getPackedProgram() const { return _packedProgram; }
+
+        /*  The last cull result of the given model, reused while valid. */
+        CullResult& getCullResult( const void* model )
+            { return _cullResults[ model ]; }
+
+        /*  The leaf draws collected in multi-draw mode.  */
+        DrawBatch& getDrawBatch() { return _drawBatch; }
         
     protected:
         VertexBufferState( const GLEWContext* glewContext );        
@@ -88,11 +139,14 @@ namespace mesh
         Range         _range; //!< normalized [0,1] part of the model to draw
         const GLEWContext* const _glewContext;
         RenderMode    _renderMode;
+        GLuint        _packedProgram;
         Vector4f      _region; //!< normalized x1 y1 x2 y2 region from cullDraw 
         bool          _useColors;
         bool          _useFrustumCulling;
         
     private:
+        std::map< const void*, CullResult > _cullResults;
+        DrawBatch _drawBatch;
     };
     
     
@@ -161,6 +215,12 @@ namespace eqPly
         virtual GLuint newShader( const void* key, GLenum type )
             { return _objectManager->newShader( key, type ); }
 
+        virtual void deleteProgram( const void* key )
+            { _objectManager->deleteProgram( key ); }
+
+        virtual void deleteShader( const void* key )
+            { _objectManager->deleteShader( key ); }
+
         virtual void deleteAll() { _objectManager->deleteAll(); }
         bool isShared() const { return _objectManager->isShared(); }
         
@@ -32,6 +32,14 @@
 
 #include <cstdlib>
 #include <algorithm>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
 
 #if (( __GNUC__ > 4 ) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 4)) )
 #  include <parallel/algorithm>
@@ -42,6 +50,12 @@ using std::sort;
 
 using namespace mesh;
 
+namespace mesh
+{
+/*  Determine whether the current architecture is little endian or not.  */
+bool isArchitectureLittleEndian();
+}
+
 /*  Contructor.  */
 VertexData::VertexData()
     : _invertFaces( false )
@@ -145,14 +159,352 @@ void VertexData::readTriangles( PlyFile* file, const int nFaces )
 }
 
 
+/** @cond IGNORE */
+namespace
+{
+/*  A read-only memory mapping of a whole file.  */
+class MappedFile
+{
+public:
+    explicit MappedFile( const std::string& filename )
+        : _data( 0 ), _size( 0 )
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFile( filename.c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ, 0, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, 0 );
+        if( file == INVALID_HANDLE_VALUE )
+            return;
+
+        LARGE_INTEGER size;
+        HANDLE map = 0;
+        if( GetFileSizeEx( file, &size ) && size.QuadPart > 0 )
+            map = CreateFileMapping( file, 0, PAGE_READONLY, 0, 0, 0 );
+        CloseHandle( file );
+        if( !map )
+            return;
+
+        _data = static_cast< const char* >( MapViewOfFile( map, FILE_MAP_READ,
+                                                           0, 0, 0 ));
+        CloseHandle( map );
+        if( _data )
+            _size = size_t( size.QuadPart );
+#else
+        const int fd = open( filename.c_str(), O_RDONLY );
+        if( fd < 0 )
+            return;
+
+        struct stat status;
+        if( fstat( fd, &status ) == 0 && status.st_size > 0 )
+        {
+            void* addr = mmap( 0, status.st_size, PROT_READ, MAP_SHARED, fd,
+                               0 );
+            if( addr != MAP_FAILED )
+            {
+                _data = static_cast< const char* >( addr );
+                _size = status.st_size;
+            }
+        }
+        close( fd );
+#endif
+    }
+
+    ~MappedFile()
+    {
+        if( !_data )
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile( _data );
+#else
+        munmap( const_cast< char* >( _data ), _size );
+#endif
+    }
+
+    const char* getData() const { return _data; }
+    size_t getSize() const { return _size; }
+
+private:
+    const char* _data;
+    size_t      _size;
+
+    MappedFile( const MappedFile& );
+    MappedFile& operator = ( const MappedFile& );
+};
+
+/*  The layout of one element of a binary PLY file.  */
+struct ElementLayout
+{
+    ElementLayout() : count( 0 ), size( 0 ), hasList( false ), x( -1 ),
+                      y( -1 ), z( -1 ), red( -1 ), green( -1 ), blue( -1 ),
+                      listCount( 0 ), listIndex( 0 ) {}
+
+    std::string name;
+    size_t      count;
+    size_t      size;       // of all scalar properties
+    bool        hasList;
+    int         x, y, z;    // float offsets, -1 if absent
+    int         red, green, blue; // uchar offsets, -1 if absent
+    size_t      listCount;  // size of the list count and index types
+    size_t      listIndex;
+};
+typedef std::vector< ElementLayout > ElementLayouts;
+
+size_t _getTypeSize( const std::string& type )
+{
+    if( type == "char" || type == "uchar" || type == "int8" ||
+        type == "uint8" )
+    {
+        return 1;
+    }
+    if( type == "short" || type == "ushort" || type == "int16" ||
+        type == "uint16" )
+    {
+        return 2;
+    }
+    if( type == "int" || type == "uint" || type == "int32" ||
+        type == "uint32" || type == "float" || type == "float32" )
+    {
+        return 4;
+    }
+    if( type == "double" || type == "float64" )
+        return 8;
+    return 0;
+}
+
+/*  Parse the header of a binary PLY file. Returns the offset of the data, or
+    0 if the file has a different format.  */
+size_t _parseHeader( const MappedFile& file, ElementLayouts& elems,
+                     bool& littleEndian )
+{
+    static const std::string end( "end_header\n" );
+    const char* data = file.getData();
+    const char* last = std::search( data, data + file.getSize(), end.begin(),
+                                    end.end( ));
+    if( last == data + file.getSize( ))
+        return 0;
+
+    std::istringstream header( std::string( data, last ));
+    std::string line;
+    if( !std::getline( header, line ) || line != "ply" ||
+        !std::getline( header, line ))
+    {
+        return 0;
+    }
+    if( line.find( "format binary_little_endian" ) == 0 )
+        littleEndian = true;
+    else if( line.find( "format binary_big_endian" ) == 0 )
+        littleEndian = false;
+    else
+        return 0;
+
+    while( std::getline( header, line ))
+    {
+        std::istringstream words( line );
+        std::string keyword;
+        words >> keyword;
+
+        if( keyword == "element" )
+        {
+            elems.push_back( ElementLayout( ));
+            words >> elems.back().name >> elems.back().count;
+            continue;
+        }
+        if( keyword != "property" )
+            continue; // comment, obj_info
+
+        if( elems.empty( ))
+            return 0;
+        ElementLayout& elem = elems.back();
+
+        std::string type, name;
+        words >> type;
+        if( type == "list" )
+        {
+            std::string countType, indexType;
+            words >> countType >> indexType;
+            elem.listCount = _getTypeSize( countType );
+            elem.listIndex = _getTypeSize( indexType );
+            if( elem.hasList || elem.listCount == 0 || elem.listIndex == 0 )
+                return 0;
+            elem.hasList = true;
+            continue;
+        }
+
+        const size_t size = _getTypeSize( type );
+        if( size == 0 || elem.hasList ) // only lists after scalars
+            return 0;
+
+        words >> name;
+        const int offset = int( elem.size );
+        elem.size += size;
+
+        if( name == "x" || name == "y" || name == "z" )
+        {
+            if( type != "float" && type != "float32" )
+                return 0;
+            ( name == "x" ? elem.x : name == "y" ? elem.y : elem.z ) = offset;
+        }
+        else if( name == "red" || name == "green" || name == "blue" )
+        {
+            if( size != 1 )
+                return 0;
+            ( name == "red" ? elem.red : name == "green" ? elem.green :
+                                                          elem.blue ) = offset;
+        }
+    }
+    return last - data + end.size();
+}
+
+template< class T > T _read( const char* in, const bool swap )
+{
+    T value;
+    memcpy( &value, in, sizeof( T ));
+    if( swap )
+    {
+        uint8_t* bytes = reinterpret_cast< uint8_t* >( &value );
+        std::reverse( bytes, bytes + sizeof( T ));
+    }
+    return value;
+}
+}
+/** @endcond */
+
+/*  Read a binary PLY file from a memory mapping, decoding the vertices and
+    faces in parallel. Returns false if the file needs the generic reader,
+    sets result otherwise.  */
+bool VertexData::readMappedPlyFile( const std::string& filename, bool& result )
+{
+    const MappedFile file( filename );
+    ElementLayouts elems;
+    bool littleEndian = true;
+    const size_t start = file.getData() ?
+                             _parseHeader( file, elems, littleEndian ) : 0;
+    if( start == 0 )
+        return false;
+    const bool swap = ( littleEndian != isArchitectureLittleEndian( ));
+
+    // locate the vertex and face blocks, all elements before them need to be
+    // of fixed size
+    const char* data = file.getData() + start;
+    const char* end = file.getData() + file.getSize();
+    const char* vertexData = 0;
+    const char* faceData = 0;
+    const ElementLayout* vertex = 0;
+    const ElementLayout* face = 0;
+
+    for( ElementLayouts::const_iterator i = elems.begin();
+         i != elems.end() && !face; ++i )
+    {
+        if( i->name == "face" )
+        {
+            // all faces need to be triangles to be decoded in parallel
+            if( !i->hasList || i->size != 0 || i->listCount != 1 ||
+                i->listIndex != 4 )
+            {
+                return false;
+            }
+            face = &(*i);
+            faceData = data;
+            break;
+        }
+        if( i->hasList )
+            return false;
+
+        if( i->name == "vertex" )
+        {
+            if( i->x < 0 || i->y < 0 || i->z < 0 )
+                return false;
+            vertex = &(*i);
+            vertexData = data;
+        }
+        if( size_t( end - data ) < i->count * i->size )
+            return false;
+        data += i->count * i->size;
+    }
+
+    if( !vertex || !face )
+        return false;
+
+    MESHINFO << "Reading " << filename << " using the memory-mapped reader"
+             << std::endl;
+
+    const size_t faceSize = 1 + 3 * 4;
+    if( size_t( end - faceData ) < face->count * faceSize )
+    {
+        MESHERROR << "Unable to read PLY file, file is truncated." << std::endl;
+        return true;
+    }
+
+    // decode vertices and colors
+    const ssize_t nVertices = vertex->count;
+    const size_t stride = vertex->size;
+    const bool hasColors = vertex->red >= 0 && vertex->green >= 0 &&
+                           vertex->blue >= 0;
+    vertices.resize( nVertices );
+    colors.resize( hasColors ? nVertices : 0 );
+
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nVertices; ++i )
+    {
+        const char* in = vertexData + i * stride;
+        const uint8_t* bytes = reinterpret_cast< const uint8_t* >( in );
+        vertices[i] = Vertex( _read< float >( in + vertex->x, swap ),
+                              _read< float >( in + vertex->y, swap ),
+                              _read< float >( in + vertex->z, swap ));
+        if( hasColors )
+            colors[i] = Color( bytes[ vertex->red ], bytes[ vertex->green ],
+                               bytes[ vertex->blue ] );
+    }
+
+    // decode triangles, asserting that they are only triangles
+    const ssize_t nFaces = face->count;
+    const uint8_t ind1 = _invertFaces ? 2 : 0;
+    const uint8_t ind3 = _invertFaces ? 0 : 2;
+    int errors = 0;
+    triangles.resize( nFaces );
+
+#pragma omp parallel for reduction( + : errors )
+    for( ssize_t i = 0; i < nFaces; ++i )
+    {
+        const char* in = faceData + i * faceSize;
+        const int32_t index[3] = { _read< int32_t >( in + 1, swap ),
+                                   _read< int32_t >( in + 5, swap ),
+                                   _read< int32_t >( in + 9, swap ) };
+
+        if( in[0] != 3 || index[0] < 0 || index[0] >= nVertices ||
+            index[1] < 0 || index[1] >= nVertices ||
+            index[2] < 0 || index[2] >= nVertices )
+        {
+            ++errors;
+            continue;
+        }
+        triangles[i] = Triangle( index[ind1], index[1], index[ind3] );
+    }
+
+    if( errors > 0 )
+    {
+        MESHERROR << "Unable to read PLY file, " << errors << " faces are not "
+                  << "triangles or have invalid vertex indices." << std::endl;
+        triangles.clear();
+        return true;
+    }
+
+    result = true;
+    return true;
+}
+
+
 /*  Open a PLY file and read vertex, color and index data.  */
 bool VertexData::readPlyFile( const std::string& filename )
 {
+    bool result = false;
+    if( readMappedPlyFile( filename, result ))
+        return result;
+
     int     nPlyElems;
     char**  elemNames;
     int     fileType;
     float   version;
-    bool    result = false;
 
     PlyFile* file = ply_open_for_reading( const_cast<char*>( filename.c_str( )),
                                           &nPlyElems, &elemNames,
@@ -238,49 +590,71 @@ bool VertexData::readPlyFile( const std::string& filename )
 }
 
 
-/*  Calculate the face or vertex normals of the current vertex data.  */
+/*  Calculate the face or vertex normals of the current vertex data. Each
+    vertex gathers the normals of its triangles in triangle order, which gives
+    the same result for any number of threads.  */
 void VertexData::calculateNormals()
 {
-#ifndef NDEBUG
-    int wrongNormals = 0;
-#endif
-
-    normals.clear();
-    normals.reserve( vertices.size() );
+    const ssize_t nTriangles = triangles.size();
+    const ssize_t nVertices = vertices.size();
 
-    // initialize all normals to zero
-    for( size_t i = 0; i < vertices.size(); ++i )
-        normals.push_back( Normal( 0, 0, 0 ) );
-
-    // iterate over all triangles and add their normals to adjacent vertices
+    // compute the normal of each triangle
+    std::vector< Normal > faceNormals( nTriangles );
 #pragma omp parallel for
-    for( ssize_t i = 0; i < ssize_t( triangles.size( )); ++i )
+    for( ssize_t i = 0; i < nTriangles; ++i )
     {
-        const Index i0 = triangles[i][0];
-        const Index i1 = triangles[i][1];
-        const Index i2 = triangles[i][2];
-        const Normal normal = vertices[i0].compute_normal( vertices[i1],
-                                                           vertices[i2] );
-#ifndef NDEBUG
-        // count emtpy normals in debug mode
-        if( normal.length() == 0.0f )
-            ++wrongNormals; // racy with OpenMP, but not critical
-#endif
-
-        normals[i0] += normal;
-        normals[i1] += normal;
-        normals[i2] += normal;
+        const Triangle& triangle = triangles[i];
+        faceNormals[i] = vertices[ triangle[0] ].compute_normal(
+                             vertices[ triangle[1] ], vertices[ triangle[2] ]);
     }
 
-    // normalize all the normals
-#pragma omp parallel for
-    for( ssize_t i = 0; i < ssize_t( vertices.size( )); ++i )
-        normals[i].normalize();
-
 #ifndef NDEBUG
+    // count emtpy normals in debug mode
+    size_t wrongNormals = 0;
+    for( ssize_t i = 0; i < nTriangles; ++i )
+        if( faceNormals[i].length() == 0.0f )
+            ++wrongNormals;
     if( wrongNormals > 0 )
         MESHINFO << wrongNormals << " faces have no valid normal." << std::endl;
 #endif
+
+    // build the triangle list of each vertex in compressed row storage by
+    // sorting all (vertex, triangle) pairs, which runs in parallel
+    typedef std::pair< Index, Index > Incidence;
+    const ssize_t nIncidences = 3 * nTriangles;
+    std::vector< Incidence > incidences( nIncidences );
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nTriangles; ++i )
+        for( size_t j = 0; j < 3; ++j )
+            incidences[ 3 * i + j ] = Incidence( triangles[i][j], i );
+    ::sort( incidences.begin(), incidences.end( ));
+
+    // the row of vertex v starts at the first incidence of a vertex >= v
+    std::vector< Index > offsets( nVertices + 1 );
+    std::vector< Index > adjacent( nIncidences );
+#pragma omp parallel for
+    for( ssize_t i = 0; i <= nIncidences; ++i )
+    {
+        const Index first = ( i == 0 ) ? 0 : incidences[ i - 1 ].first + 1;
+        const Index last = ( i == nIncidences ) ? nVertices :
+                                                  incidences[i].first;
+        for( Index v = first; v <= last; ++v )
+            offsets[ v ] = i;
+        if( i < nIncidences )
+            adjacent[i] = incidences[i].second;
+    }
+
+    // sum up and normalize the normals of the adjacent triangles
+    normals.resize( nVertices );
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nVertices; ++i )
+    {
+        Normal normal( 0, 0, 0 );
+        for( Index j = offsets[i]; j < offsets[ i + 1 ]; ++j )
+            normal += faceNormals[ adjacent[j] ];
+        normal.normalize();
+        normals[i] = normal;
+    }
 }
 
 
@@ -66,6 +66,7 @@ namespace mesh
         void readVertices( PlyFile* file, const int nVertices, 
                            const bool readColors );
         void readTriangles( PlyFile* file, const int nFaces );
+        bool readMappedPlyFile( const std::string& filename, bool& result );
 
         BoundingBox _boundingBox;
         bool        _invertFaces;
@@ -35,10 +35,12 @@
 #include "vertexBufferState.h"
 
 #include "fragmentShader.glsl.h"
+#include "packedVertexShader.glsl.h"
 #include "vertexShader.glsl.h"
 
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 namespace eqPly
 {
@@ -94,6 +96,7 @@ bool Window::configInitGL( const eq::uint128_t& initID )
 
     if( initData.useGLSL() )
         _loadShaders();
+    _loadPackedShaders();
 
     return true;
 }
@@ -216,6 +219,85 @@ void Window::_loadShaders()
     LBINFO << "Shaders loaded successfully" << std::endl;
 }
 
+void Window::_loadPackedShaders()
+{
+    GLuint program = _state->getProgram( packedVertexShader_glsl );
+    if( program != VertexBufferState::INVALID )
+    {
+        // already loaded
+        _state->setPackedProgram( program );
+        return;
+    }
+
+    // The packed vertex format is only decoded by a shader
+    if( !GLEW_VERSION_2_0 )
+        return;
+
+    const GLuint vShader = _loadShader( packedVertexShader_glsl,
+                                        GL_VERTEX_SHADER );
+    const GLuint fShader = _loadShader( fragmentShader_glsl,
+                                        GL_FRAGMENT_SHADER );
+    if( vShader == VertexBufferState::INVALID ||
+        fShader == VertexBufferState::INVALID )
+    {
+        LBWARN << "Failed to compile packed vertex shader" << std::endl;
+        return;
+    }
+
+    program = _state->newProgram( packedVertexShader_glsl );
+    LBASSERT( program != VertexBufferState::INVALID );
+    glAttachShader( program, vShader );
+    glAttachShader( program, fShader );
+    glBindAttribLocation( program, mesh::PACKED_POSITION_ATTRIBUTE,
+                          "packedPosition" );
+    glBindAttribLocation( program, mesh::PACKED_NORMAL_ATTRIBUTE,
+                          "packedNormal" );
+    glBindAttribLocation( program, mesh::PACKED_ORIGIN_ATTRIBUTE,
+                          "leafOrigin" );
+    glBindAttribLocation( program, mesh::PACKED_SCALE_ATTRIBUTE, "leafScale" );
+    glLinkProgram( program );
+
+    GLint status;
+    glGetProgramiv( program, GL_LINK_STATUS, &status );
+    if( !status )
+    {
+        LBWARN << "Failed to link packed shader program" << std::endl;
+        _state->deleteProgram( packedVertexShader_glsl );
+        return;
+    }
+    _state->setPackedProgram( program );
+}
+
+GLuint Window::_loadShader( const GLchar* source, const GLenum type )
+{
+    GLint status;
+    GLuint shader = _state->getShader( source );
+    if( shader != VertexBufferState::INVALID )
+    {
+        // may have been compiled unsuccessfully by _loadShaders
+        glGetShaderiv( shader, GL_COMPILE_STATUS, &status );
+        return status ? shader : VertexBufferState::INVALID;
+    }
+
+    shader = _state->newShader( source, type );
+    LBASSERT( shader != VertexBufferState::INVALID );
+    glShaderSource( shader, 1, &source, 0 );
+    glCompileShader( shader );
+
+    glGetShaderiv( shader, GL_COMPILE_STATUS, &status );
+    if( status )
+        return shader;
+
+    GLint length = 0;
+    glGetShaderiv( shader, GL_INFO_LOG_LENGTH, &length );
+    std::vector< GLchar > log( length + 1, 0 );
+    glGetShaderInfoLog( shader, length, 0, &log[0] );
+    LBWARN << "Failed to compile shader: " << &log[0] << std::endl;
+
+    _state->deleteShader( source );
+    return VertexBufferState::INVALID;
+}
+
 void Window::frameStart( const eq::uint128_t& frameID, const uint32_t frameNumber )
 {
     const Pipe*      pipe      = static_cast<Pipe*>( getPipe( ));
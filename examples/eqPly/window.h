@@ -65,6 +65,8 @@ namespace eqPly
 
         void _loadLogo();
         void _loadShaders();
+        void _loadPackedShaders();
+        GLuint _loadShader( const GLchar* source, const GLenum type );
     };
 }
 
@@ -0,0 +1,55 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests that pixel buffers of varying sizes are recycled by the buffer pool
+
+#include <test.h>
+#include <eq/client/detail/bufferPool.h>
+
+int main( int argc, char **argv )
+{
+    eq::detail::BufferPool& pool = eq::detail::BufferPool::getInstance();
+    lunchbox::Bufferb buffer;
+
+    pool.resize( buffer, 3000000 );
+    TEST( buffer.getSize() == 3000000 );
+    eq::detail::BufferPool::Statistics stats = pool.getStatistics();
+    TEST( stats.misses == 1 );
+    TEST( stats.hits == 0 );
+    TEST( stats.allocated == 4194304 );
+
+    // fits, no pool access
+    pool.resize( buffer, 4000000 );
+    TEST( pool.getStatistics().misses == 1 );
+
+    // the released buffer serves the next request of the same size class
+    pool.release( buffer );
+    TEST( buffer.getMaxSize() == 0 );
+    lunchbox::Bufferb other;
+    pool.resize( other, 2500000 );
+    stats = pool.getStatistics();
+    TEST( stats.hits == 1 );
+    TEST( stats.misses == 1 );
+
+    // growing returns the small buffer and allocates a larger one
+    pool.resize( other, 5000000 );
+    stats = pool.getStatistics();
+    TEST( stats.misses == 2 );
+    TESTINFO( stats.peak == 4194304 + 8388608, stats );
+
+    pool.release( other );
+    return EXIT_SUCCESS;
+}
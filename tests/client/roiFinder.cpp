@@ -0,0 +1,222 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests the CPU region of interest detection and the splitting of memory
+// images on synthetic sparse images
+
+#include <test.h>
+
+#include <eq/client/detail/roiKernels.h>
+#include <eq/client/image.h>
+#include <eq/client/init.h>
+#include <eq/client/nodeFactory.h>
+#include <eq/client/pixelData.h>
+#include <eq/client/roiFinder.h>
+#include <lunchbox/plugins/compressor.h>
+#include <lunchbox/rng.h>
+
+#include <vector>
+
+using eq::PixelViewport;
+
+namespace
+{
+static const int32_t _width = 640;
+static const int32_t _height = 480;
+static const uint32_t _far = 0xffffffffu;
+
+typedef std::vector< uint32_t > Buffer;
+
+// two separate objects on a black background at the far plane
+const PixelViewport _objects[] = { PixelViewport( 37, 50, 100, 80 ),
+                                   PixelViewport( 400, 300, 150, 120 ) };
+
+void _setPixels( eq::Image& image, const eq::Frame::Buffer buffer,
+                 Buffer& pixels, const uint32_t format )
+{
+    eq::PixelData data;
+    data.internalFormat = format;
+    data.externalFormat = format;
+    data.pixelSize = 4;
+    data.pvp = PixelViewport( 0, 0, _width, _height );
+    data.pixels = &pixels[0];
+    image.setPixelData( buffer, data );
+}
+
+void _setImage( eq::Image& image, const size_t nObjects,
+                const int32_t offsetX = 0, const int32_t offsetY = 0 )
+{
+    Buffer color( _width * _height, 0 );
+    Buffer depth( _width * _height, _far );
+
+    for( size_t i = 0; i < nObjects; ++i )
+    {
+        const PixelViewport& object = _objects[i];
+        for( int32_t y = object.y; y < object.getYEnd(); ++y )
+            for( int32_t x = object.x; x < object.getXEnd(); ++x )
+            {
+                color[ y * _width + x ] = uint32_t( x ) << 16 | uint32_t( y );
+                depth[ y * _width + x ] = uint32_t( i + 1 ) << 20;
+            }
+    }
+
+    image.reset();
+    image.setPixelViewport( PixelViewport( offsetX, offsetY, _width, _height ));
+    _setPixels( image, eq::Frame::BUFFER_COLOR, color,
+                EQ_COMPRESSOR_DATATYPE_RGBA );
+    _setPixels( image, eq::Frame::BUFFER_DEPTH, depth,
+                EQ_COMPRESSOR_DATATYPE_DEPTH_UNSIGNED_INT );
+}
+
+bool _covers( const eq::PixelViewports& regions, const PixelViewport& object )
+{
+    for( int32_t y = object.y; y < object.getYEnd(); ++y )
+        for( int32_t x = object.x; x < object.getXEnd(); ++x )
+        {
+            bool found = false;
+            for( size_t i = 0; i < regions.size() && !found; ++i )
+                found = regions[i].isInside( x, y );
+            if( !found )
+                return false;
+        }
+    return true;
+}
+
+// @return true if the image holds the pixels of _setImage within its pvp
+bool _checkPixels( const eq::Image& image )
+{
+    const PixelViewport& pvp = image.getPixelViewport();
+    const uint32_t* color = reinterpret_cast< const uint32_t* >(
+        image.getPixelPointer( eq::Frame::BUFFER_COLOR ));
+    for( int32_t y = 0; y < pvp.h; ++y )
+        for( int32_t x = 0; x < pvp.w; ++x )
+        {
+            const uint32_t pixel = color[ y * pvp.w + x ];
+            if( pixel != 0 &&
+                pixel != ( uint32_t( pvp.x + x ) << 16 | uint32_t( pvp.y + y )))
+            {
+                return false;
+            }
+        }
+    return true;
+}
+
+void _testKernels()
+{
+    lunchbox::RNG rng;
+    Buffer pixels( _width );
+    const eq::detail::MarkBlocksRowFunc scalar =
+        eq::detail::getMarkBlocksRow( eq::detail::KERNEL_SCALAR );
+
+    for( size_t i = 0; i < 100; ++i )
+    {
+        std::fill( pixels.begin(), pixels.end(), _far );
+        const size_t nPixels = _width - rng.get< uint8_t >() % 16;
+        pixels[ rng.get< uint16_t >() % nPixels ] = 0;
+
+        std::vector< uint8_t > expected( _width / 16, 0 );
+        scalar( &expected[0], &pixels[0], nPixels, _far, _far );
+
+        for( int k = eq::detail::KERNEL_SSE2; k < eq::detail::KERNEL_ALL; ++k )
+        {
+            const eq::detail::CompositorKernel kernel =
+                eq::detail::CompositorKernel( k );
+            if( !eq::detail::hasKernel( kernel ))
+                continue;
+
+            std::vector< uint8_t > blocks( _width / 16, 0 );
+            eq::detail::getMarkBlocksRow( kernel )( &blocks[0], &pixels[0],
+                                                    nPixels, _far, _far );
+            TESTINFO( blocks == expected, eq::detail::getKernelName( kernel ));
+        }
+    }
+}
+}
+
+int main( int argc, char **argv )
+{
+    eq::NodeFactory nodeFactory;
+    TEST( eq::init( argc, argv, &nodeFactory ));
+
+    _testKernels();
+
+    eq::ROIFinder finder;
+    eq::Image image;
+    const PixelViewport full( 0, 0, _width, _height );
+
+    // all background
+    _setImage( image, 0 );
+    TEST( finder.findRegions( image ).empty( ));
+
+    // sparse foreground
+    _setImage( image, 2 );
+    const eq::PixelViewports regions = finder.findRegions( image );
+    TEST( !regions.empty( ));
+
+    uint32_t area = 0;
+    for( size_t i = 0; i < regions.size(); ++i )
+    {
+        PixelViewport region = regions[i];
+        region.intersect( full );
+        TESTINFO( region == regions[i], regions[i] );
+        area += region.getArea();
+    }
+    TEST( _covers( regions, _objects[0] ));
+    TEST( _covers( regions, _objects[1] ));
+    TESTINFO( area < full.getArea() / 4, area << " of " << full.getArea( ));
+
+    // split into sub-images and crop the original to the first region
+    std::vector< eq::Image* > parts;
+    for( size_t i = 1; i < regions.size(); ++i )
+    {
+        eq::Image* part = new eq::Image;
+        TEST( part->setPixelData( image, regions[i] ));
+        TEST( part->getPixelViewport() == regions[i] );
+        TEST( part->hasPixelData( eq::Frame::BUFFER_DEPTH ));
+        TEST( _checkPixels( *part ));
+        parts.push_back( part );
+    }
+    TEST( image.crop( regions[0] ));
+    TEST( image.getPixelViewport() == regions[0] );
+    TEST( image.getPixelDataSize( eq::Frame::BUFFER_COLOR ) ==
+          regions[0].getArea() * 4 );
+    TEST( _checkPixels( image ));
+    TEST( !image.crop( full ));
+
+    for( size_t i = 0; i < parts.size(); ++i )
+        delete parts[i];
+
+    // offset images report regions in image coordinates
+    _setImage( image, 1, 100, 200 );
+    const eq::PixelViewports offsetRegions = finder.findRegions( image );
+    TEST( !offsetRegions.empty( ));
+    for( size_t i = 0; i < offsetRegions.size(); ++i )
+        TESTINFO( offsetRegions[i].x >= 100 && offsetRegions[i].y >= 200,
+                  offsetRegions[i] );
+
+    // images without depth are not analyzed
+    _setImage( image, 2 );
+    image.setPixelViewport( full );
+    Buffer color( _width * _height, 0 );
+    _setPixels( image, eq::Frame::BUFFER_COLOR, color,
+                EQ_COMPRESSOR_DATATYPE_RGBA );
+    const eq::PixelViewports colorRegions = finder.findRegions( image );
+    TEST( colorRegions.size() == 1 && colorRegions[0] == full );
+
+    eq::exit();
+    return EXIT_SUCCESS;
+}
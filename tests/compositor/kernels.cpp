@@ -0,0 +1,149 @@
+/* Copyright (c) 2013, Stefan Eilemann <eile@equalizergraphics.com>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <test.h>
+
+#include <eq/client/detail/compositorKernels.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/rng.h>
+
+#include <cstring>
+#include <vector>
+
+// Tests that the SIMD compositor kernels produce the same output as the scalar
+// fallback and reports the throughput of each kernel for a 4K frame.
+
+namespace
+{
+static const size_t width = 3840;
+static const size_t height = 2160;
+static const size_t nPixels = width * height;
+static const size_t nLoops = 5;
+
+typedef std::vector< uint32_t > Buffer;
+
+void _fill( Buffer& buffer, lunchbox::RNG& rng )
+{
+    for( Buffer::iterator i = buffer.begin(); i != buffer.end(); ++i )
+        *i = rng.get< uint32_t >();
+}
+
+void _print( const char* name, const eq::detail::CompositorKernel kernel,
+             const float time )
+{
+    std::cout << name << " " << eq::detail::getKernelName( kernel ) << ": "
+              << time / nLoops << " ms ("
+              << nPixels * nLoops / time / 1000.f << " Mpixel/s)"
+              << std::endl;
+}
+}
+
+int main( int argc, char **argv )
+{
+    lunchbox::RNG rng;
+    Buffer color( nPixels ), depth( nPixels );
+    Buffer destColor( nPixels ), destDepth( nPixels );
+    _fill( color, rng );
+    _fill( depth, rng );
+    _fill( destColor, rng );
+    _fill( destDepth, rng );
+
+    Buffer refColor = destColor, refDepth = destDepth;
+    Buffer refBlend = destColor;
+    for( size_t y = 0; y < height; ++y )
+    {
+        const size_t skip = y * width;
+        eq::detail::mergeDepthRow_C( &refColor[skip], &refDepth[skip],
+                                     &color[skip], &depth[skip], width );
+        eq::detail::mergeBlendRow_C(
+            reinterpret_cast< uint8_t* >( &refBlend[skip] ),
+            reinterpret_cast< const uint8_t* >( &color[skip] ), width );
+    }
+
+    lunchbox::Clock clock;
+    for( int i = 0; i < eq::detail::KERNEL_ALL; ++i )
+    {
+        const eq::detail::CompositorKernel kernel =
+            eq::detail::CompositorKernel( i );
+        if( !eq::detail::hasKernel( kernel ))
+        {
+            std::cout << eq::detail::getKernelName( kernel )
+                      << " not supported" << std::endl;
+            continue;
+        }
+
+        // 1) depth compare-and-select
+        const eq::detail::MergeDepthRowFunc mergeRow =
+            eq::detail::getMergeDepthRow( kernel );
+        TEST( mergeRow );
+
+        Buffer outColor, outDepth;
+        float time = 0.f;
+        for( size_t j = 0; j < nLoops; ++j )
+        {
+            outColor = destColor;
+            outDepth = destDepth;
+            clock.reset();
+            for( size_t y = 0; y < height; ++y )
+            {
+                const size_t skip = y * width;
+                mergeRow( &outColor[skip], &outDepth[skip], &color[skip],
+                          &depth[skip], width );
+            }
+            time += clock.getTimef();
+        }
+        TEST( outColor == refColor );
+        TEST( outDepth == refDepth );
+        _print( "DB   ", kernel, time );
+
+        // 2) premultiplied alpha blending
+        const eq::detail::MergeBlendRowFunc blendRow =
+            eq::detail::getMergeBlendRow( kernel );
+        TEST( blendRow );
+
+        time = 0.f;
+        for( size_t j = 0; j < nLoops; ++j )
+        {
+            outColor = destColor;
+            clock.reset();
+            for( size_t y = 0; y < height; ++y )
+            {
+                const size_t skip = y * width;
+                blendRow( reinterpret_cast< uint8_t* >( &outColor[skip] ),
+                          reinterpret_cast< const uint8_t* >( &color[skip] ),
+                          width );
+            }
+            time += clock.getTimef();
+        }
+        TEST( outColor == refBlend );
+        _print( "Blend", kernel, time );
+    }
+
+    // 3) 2D assembly is a row-wise memcpy for all instruction sets
+    Buffer outColor( nPixels );
+    clock.reset();
+    for( size_t j = 0; j < nLoops; ++j )
+        for( size_t y = 0; y < height; ++y )
+            memcpy( &outColor[ y * width ], &color[ y * width ],
+                    width * sizeof( uint32_t ));
+    const float time = clock.getTimef();
+    TEST( outColor == color );
+    _print( "2D   ", eq::detail::KERNEL_SCALAR, time );
+    std::cout << "Compositor uses "
+              << eq::detail::getKernelName( eq::detail::getBestKernel( ))
+              << " kernels" << std::endl;
+    return EXIT_SUCCESS;
+}
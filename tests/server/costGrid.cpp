@@ -0,0 +1,115 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests the load equalizer cost model and replays a moving hot spot through
+// it, reporting the imbalance of the resulting sort-first splits
+
+#include <test.h>
+#include <eq/server/equalizers/costGrid.h>
+
+#include <algorithm>
+#include <cmath>
+
+using eq::fabric::Viewport;
+
+namespace
+{
+static const size_t _nSources = 4;
+static const size_t _nFrames = 200;
+static const size_t _warmup = 10;
+
+// uniform background and a hot spot of 10% width moving to the right
+float _render( const float start, const float end, const uint32_t frame )
+{
+    const float hotSpot = .05f + .8f * float( frame ) / float( _nFrames );
+    const float overlap = std::min( end, hotSpot + .1f ) -
+                          std::max( start, hotSpot );
+    return 10.f * ( end - start ) + 40.f * std::max( overlap, 0.f ) / .1f;
+}
+
+// @return the mean ratio of the slowest to the average source
+float _replay( const bool youngestFrameOnly )
+{
+    eq::server::CostGrid grid( 128, 128 );
+    float imbalance = 0.f;
+
+    for( uint32_t frame = 0; frame < _nFrames; ++frame )
+    {
+        // balance vertical strips at equal predicted cost
+        std::vector< float > splits( 1, 0.f );
+        const float cost = grid.getCost( Viewport( ));
+        for( size_t i = 1; i < _nSources; ++i )
+            splits.push_back( grid.isEmpty() ? float( i ) / _nSources :
+                              grid.getSplitX( Viewport(), cost*i/_nSources ));
+        splits.push_back( 1.f );
+
+        // the former load equalizer used only the youngest complete frame
+        if( youngestFrameOnly )
+            grid.clear();
+
+        float maxTime = 0.f;
+        float sumTime = 0.f;
+        for( size_t i = 0; i < _nSources; ++i )
+        {
+            const float time = _render( splits[i], splits[i+1], frame );
+            grid.addTime( Viewport( splits[i], 0.f, splits[i+1] - splits[i],
+                                    1.f ), time );
+            maxTime = std::max( maxTime, time );
+            sumTime += time;
+        }
+        grid.update();
+
+        if( frame >= _warmup )
+            imbalance += maxTime * _nSources / sumTime;
+    }
+    return imbalance / float( _nFrames - _warmup );
+}
+}
+
+int main( int argc, char **argv )
+{
+    eq::server::CostGrid grid( 128, 128 );
+    TEST( grid.isEmpty( ));
+
+    // 3/4 of the cost in the left half
+    grid.addTime( Viewport( 0.f, 0.f, .5f, 1.f ), 30.f );
+    grid.addTime( Viewport( .5f, 0.f, .5f, 1.f ), 10.f );
+    grid.update();
+    TEST( !grid.isEmpty( ));
+    TESTINFO( std::abs( grid.getCost( Viewport( )) - 40.f ) < .01f,
+              grid.getCost( Viewport( )));
+    TESTINFO( std::abs( grid.getSplitX( Viewport(), 20.f ) - 1.f/3.f ) < .001f,
+              grid.getSplitX( Viewport(), 20.f ));
+    TESTINFO( std::abs( grid.getSplitY( Viewport(), 20.f ) - .5f ) < .001f,
+              grid.getSplitY( Viewport(), 20.f ));
+
+    // DB ranges on the x axis
+    grid.resize( 1024, 1 );
+    TEST( grid.isEmpty( ));
+    grid.addTime( Viewport( .1f, 0.f, .3f, 1.f ), 5.f );
+    grid.update();
+    TESTINFO( std::abs( grid.getSplitX( Viewport(), 2.5f ) - .25f ) < .001f,
+              grid.getSplitX( Viewport(), 2.5f ));
+
+    const float youngest = _replay( true );
+    const float predicted = _replay( false );
+    std::cout << "Imbalance of " << _nSources << " sources over " << _nFrames
+              << " frames: youngest frame " << youngest << ", predicted "
+              << predicted << std::endl;
+    TESTINFO( predicted < youngest, predicted << " >= " << youngest );
+    return EXIT_SUCCESS;
+}
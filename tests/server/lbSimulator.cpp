@@ -0,0 +1,562 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Simulates the equalizers of a configuration without any render client:
+// the compounds are updated for a number of frames, synthetic render times of
+// the resulting decomposition are fed back as channel load data, and the
+// balance of each frame is reported. Without arguments, a set of example
+// configurations is checked for convergence.
+
+#include <test.h>
+
+#include <eq/server/canvas.h>
+#include <eq/server/channel.h>
+#include <eq/server/compound.h>
+#include <eq/server/compoundVisitor.h>
+#include <eq/server/config.h>
+#include <eq/server/global.h>
+#include <eq/server/loader.h>
+#include <eq/server/node.h>
+#include <eq/server/observer.h>
+#include <eq/server/pipe.h>
+#include <eq/server/server.h>
+#include <eq/server/window.h>
+
+#include <eq/client/statistic.h>
+#include <eq/fabric/task.h>
+#include <eq/client/version.h>
+#include <lunchbox/init.h>
+
+#ifndef MIN
+#  define MIN LB_MIN
+#endif
+#include <tclap/CmdLine.h>
+
+#include <cmath>
+#include <cstring>
+#include <map>
+
+using eq::fabric::Viewport;
+using eq::fabric::Range;
+
+namespace
+{
+enum CostModel
+{
+    COST_UNIFORM, //!< same cost everywhere
+    COST_HOTSPOT, //!< an expensive area in the center
+    COST_MOVING   //!< an expensive area moving from left to right
+};
+
+struct Setup
+{
+    Setup() : model( COST_HOTSPOT ), heterogeneous( true ), nFrames( 100 )
+            , verbose( false ) {}
+
+    CostModel model;
+    bool heterogeneous; //!< every second channel renders at half speed
+    uint32_t nFrames;
+    bool verbose;
+};
+
+// Synthetic costs in milliseconds for a full destination channel
+static const float _drawTime = 40.f;
+static const float _hotSpotTime = 80.f;
+static const float _readbackTime = 4.f;
+static const float _assembleTime = 2.f;
+
+class Cost
+{
+public:
+    explicit Cost( const Setup& setup ) : _setup( setup ) {}
+
+    /** @return the draw time of a part of the destination and model. */
+    float getDrawTime( const Viewport& vp, const Range& range,
+                       const uint32_t frame ) const
+    {
+        float time = _drawTime * vp.getArea();
+        if( _setup.model != COST_UNIFORM )
+        {
+            const Viewport hotSpot = _getHotSpot( frame );
+            Viewport overlap( vp );
+            overlap.intersect( hotSpot );
+            if( overlap.hasArea( ))
+                time += _hotSpotTime * overlap.getArea() / hotSpot.getArea();
+        }
+        return time * range.getSize();
+    }
+
+    /** @return the relative speed of the given GPU. */
+    float getSpeed( const size_t index ) const
+        { return ( _setup.heterogeneous && ( index % 2 )) ? .5f : 1.f; }
+
+private:
+    const Setup& _setup;
+
+    Viewport _getHotSpot( const uint32_t frame ) const
+    {
+        if( _setup.model == COST_HOTSPOT )
+            return Viewport( .4f, .4f, .2f, .2f );
+
+        const float x = .8f * float( frame % _setup.nFrames ) /
+                        float( _setup.nFrames );
+        return Viewport( x, .4f, .2f, .2f );
+    }
+};
+
+struct Result
+{
+    Result() : makespan( 0.f ), imbalance( 1.f ), jitter( 0.f ) {}
+
+    float makespan;  //!< time from frame start to the last finished task
+    float imbalance; //!< slowest draw time of a channel to the average
+    float jitter;    //!< mean change of the source viewports and ranges
+};
+typedef std::vector< Result > Results;
+
+/** Runs the tasks of one frame and collects their statistics per channel. */
+class FrameVisitor : public eq::server::CompoundVisitor
+{
+public:
+    typedef std::map< eq::server::Channel*, size_t > ChannelIndices;
+    typedef std::map< eq::server::Channel*, eq::Statistics > ChannelStatistics;
+    typedef std::map< eq::server::Channel*, float > ChannelTimes;
+
+    FrameVisitor( const Cost& cost, const ChannelIndices& indices,
+                  const uint32_t frame, const float start )
+        : _cost( cost ), _indices( indices ), _frame( frame ), _start( start )
+        , _readyTime( start ) {}
+
+    virtual eq::server::VisitorResult visit( eq::server::Compound* compound )
+    {
+        eq::server::Channel* channel = compound->getChannel();
+        if( !channel || !compound->isActive( ))
+            return eq::server::TRAVERSE_CONTINUE;
+
+        ChannelIndices::const_iterator i = _indices.find( channel );
+        const float speed = _cost.getSpeed( i == _indices.end() ? 0 :
+                                            i->second );
+        const Viewport& vp = compound->getInheritViewport();
+        const Range& range = compound->getInheritRange();
+        const eq::fabric::Zoom& zoom = compound->getInheritZoom();
+        const float pixels = zoom.x() * zoom.y();
+
+        if( compound->testInheritTask( eq::fabric::TASK_DRAW ))
+        {
+            const float time = pixels / speed *
+                               _cost.getDrawTime( vp, range, _frame );
+            _add( channel, compound, eq::Statistic::CHANNEL_DRAW, time );
+            _drawTimes[ channel ] += time;
+        }
+        if( compound->testInheritTask( eq::fabric::TASK_READBACK ) &&
+            !compound->getOutputFrames().empty( ))
+        {
+            _add( channel, compound, eq::Statistic::CHANNEL_READBACK,
+                  pixels * _readbackTime * vp.getArea( ));
+            _readyTime = LB_MAX( _readyTime, _times[ channel ] );
+        }
+        return eq::server::TRAVERSE_CONTINUE;
+    }
+
+    /** Assemble all input frames once the sources are done. */
+    void assemble( eq::server::Compound* compound )
+    {
+        eq::server::Channel* channel = compound->getChannel();
+        const size_t nFrames = compound->getInputFrames().size();
+        if( !channel || !compound->isActive() || nFrames == 0 ||
+            !compound->testInheritTask( eq::fabric::TASK_ASSEMBLE ))
+        {
+            return;
+        }
+
+        _times[ channel ] = LB_MAX( _getTime( channel ), _readyTime );
+        _add( channel, compound, eq::Statistic::CHANNEL_ASSEMBLE,
+              _assembleTime * float( nFrames ) *
+              compound->getInheritViewport().getArea( ));
+    }
+
+    /** Send the statistics to the channel listeners. */
+    float finish( Result& result )
+    {
+        for( ChannelStatistics::const_iterator i = _statistics.begin();
+             i != _statistics.end(); ++i )
+        {
+            i->first->fireLoadData( _frame, i->second, Viewport::FULL );
+        }
+
+        float end = _start;
+        for( ChannelTimes::const_iterator i = _times.begin();
+             i != _times.end(); ++i )
+        {
+            end = LB_MAX( end, i->second );
+        }
+
+        float maxTime = 0.f;
+        float sumTime = 0.f;
+        for( ChannelTimes::const_iterator i = _drawTimes.begin();
+             i != _drawTimes.end(); ++i )
+        {
+            maxTime = LB_MAX( maxTime, i->second );
+            sumTime += i->second;
+        }
+
+        result.makespan = end - _start;
+        if( sumTime > 0.f )
+            result.imbalance = maxTime * float( _drawTimes.size( )) / sumTime;
+        return end;
+    }
+
+private:
+    const Cost& _cost;
+    const ChannelIndices& _indices;
+    const uint32_t _frame;
+    const float _start;
+    float _readyTime; //!< time when all output frames are read back
+
+    ChannelStatistics _statistics;
+    ChannelTimes _times;     //!< end of the last task per channel
+    ChannelTimes _drawTimes; //!< draw time per channel
+
+    float _getTime( eq::server::Channel* channel )
+    {
+        ChannelTimes::iterator i = _times.find( channel );
+        if( i == _times.end( ))
+            i = _times.insert( std::make_pair( channel, _start )).first;
+        return i->second;
+    }
+
+    void _add( eq::server::Channel* channel,
+               const eq::server::Compound* compound,
+               const eq::Statistic::Type type, const float time )
+    {
+        const float start = _getTime( channel );
+        const float end = start + time;
+        _times[ channel ] = end;
+
+        eq::Statistic stat;
+        stat.type = type;
+        stat.frameNumber = _frame;
+        stat.task = compound->getTaskID();
+        stat.startTime = int64_t( start + .5f );
+        stat.endTime = int64_t( end + .5f );
+        strncpy( stat.resourceName, channel->getName().c_str(), 31 );
+        stat.resourceName[31] = 0;
+        _statistics[ channel ].push_back( stat );
+    }
+};
+
+/** Collects the destination compounds for the assembly pass. */
+class AssembleVisitor : public eq::server::CompoundVisitor
+{
+public:
+    explicit AssembleVisitor( FrameVisitor& frame ) : _frame( frame ) {}
+
+    virtual eq::server::VisitorResult visitPost(
+        eq::server::Compound* compound )
+    {
+        _frame.assemble( compound );
+        return eq::server::TRAVERSE_CONTINUE;
+    }
+    virtual eq::server::VisitorResult visitLeaf(
+        eq::server::Compound* compound )
+    {
+        return visitPost( compound );
+    }
+
+private:
+    FrameVisitor& _frame;
+};
+
+/** Accumulates the change of all source decompositions. */
+class JitterVisitor : public eq::server::CompoundVisitor
+{
+public:
+    typedef std::pair< Viewport, Range > Decomposition;
+    typedef std::map< const eq::server::Compound*, Decomposition > History;
+
+    explicit JitterVisitor( History& history )
+        : _history( history ), _jitter( 0.f ), _nCompounds( 0 ) {}
+
+    virtual eq::server::VisitorResult visitLeaf(
+        eq::server::Compound* compound )
+    {
+        if( !compound->isActive( ))
+            return eq::server::TRAVERSE_CONTINUE;
+
+        const Decomposition current( compound->getInheritViewport(),
+                                     compound->getInheritRange( ));
+        History::iterator i = _history.find( compound );
+        if( i != _history.end( ))
+        {
+            const Decomposition& last = i->second;
+            _jitter += std::abs( current.first.x - last.first.x ) +
+                       std::abs( current.first.y - last.first.y ) +
+                       std::abs( current.first.w - last.first.w ) +
+                       std::abs( current.first.h - last.first.h ) +
+                       std::abs( current.second.start - last.second.start ) +
+                       std::abs( current.second.end - last.second.end );
+        }
+        _history[ compound ] = current;
+        ++_nCompounds;
+        return eq::server::TRAVERSE_CONTINUE;
+    }
+
+    float getJitter() const
+        { return _nCompounds ? _jitter / float( _nCompounds ) : 0.f; }
+
+private:
+    History& _history;
+    float _jitter;
+    size_t _nCompounds;
+};
+
+/** Set up a loaded config as if all its resources were running. */
+void _initConfig( eq::server::Config* config,
+                  FrameVisitor::ChannelIndices& indices )
+{
+    const eq::server::Nodes& nodes = config->getNodes();
+    for( eq::server::NodesCIter i = nodes.begin(); i != nodes.end(); ++i )
+    {
+        const eq::server::Pipes& pipes = (*i)->getPipes();
+        for( eq::server::PipesCIter j = pipes.begin(); j != pipes.end(); ++j )
+        {
+            eq::server::Pipe* pipe = *j;
+            if( !pipe->getPixelViewport().hasArea( ))
+                pipe->setPixelViewport( eq::PixelViewport( 0, 0, 1920, 1200 ));
+
+            const eq::server::Windows& windows = pipe->getWindows();
+            for( eq::server::WindowsCIter k = windows.begin();
+                 k != windows.end(); ++k )
+            {
+                const eq::server::Channels& channels = (*k)->getChannels();
+                for( eq::server::ChannelsCIter l = channels.begin();
+                     l != channels.end(); ++l )
+                {
+                    eq::server::Channel* channel = *l;
+                    channel->setState( eq::server::STATE_RUNNING );
+                    const size_t index = indices.size();
+                    indices[ channel ] = index;
+                }
+            }
+        }
+    }
+
+    const eq::server::Compounds& compounds = config->getCompounds();
+    for( eq::server::CompoundsCIter i = compounds.begin();
+         i != compounds.end(); ++i )
+    {
+        (*i)->init();
+    }
+
+    const eq::server::Observers& observers = config->getObservers();
+    for( eq::server::ObserversCIter i = observers.begin();
+         i != observers.end(); ++i )
+    {
+        (*i)->init();
+    }
+
+    const eq::server::Canvases& canvases = config->getCanvases();
+    for( eq::server::CanvasesCIter i = canvases.begin();
+         i != canvases.end(); ++i )
+    {
+        (*i)->init();
+    }
+
+    for( eq::server::CompoundsCIter i = compounds.begin();
+         i != compounds.end(); ++i )
+    {
+        (*i)->updateData( 0 );
+    }
+}
+
+Results _simulate( const std::string& filename, const Setup& setup )
+{
+    eq::server::Loader loader;
+    eq::server::ServerPtr server = loader.loadFile( filename );
+    TESTINFO( server.isValid(), "Load of " << filename << " failed" );
+
+    eq::server::Loader::addOutputCompounds( server );
+    eq::server::Loader::addDestinationViews( server );
+    eq::server::Loader::addDefaultObserver( server );
+    eq::server::Loader::convertTo11( server );
+    eq::server::Loader::convertTo12( server );
+
+    const eq::server::Configs& configs = server->getConfigs();
+    TESTINFO( configs.size() == 1, configs.size() << " in " << filename );
+    eq::server::Config* config = configs.front();
+
+    FrameVisitor::ChannelIndices indices;
+    _initConfig( config, indices );
+
+    const Cost cost( setup );
+    const eq::server::Compounds& compounds = config->getCompounds();
+    JitterVisitor::History history;
+    Results results( setup.nFrames );
+    float time = 0.f;
+
+    for( uint32_t frame = 1; frame <= setup.nFrames; ++frame )
+    {
+        for( eq::server::CompoundsCIter i = compounds.begin();
+             i != compounds.end(); ++i )
+        {
+            (*i)->updateData( frame );
+        }
+
+        FrameVisitor frameVisitor( cost, indices, frame, time );
+        AssembleVisitor assembleVisitor( frameVisitor );
+        JitterVisitor jitterVisitor( history );
+        for( eq::server::CompoundsCIter i = compounds.begin();
+             i != compounds.end(); ++i )
+        {
+            (*i)->accept( frameVisitor );
+            (*i)->accept( assembleVisitor );
+            (*i)->accept( jitterVisitor );
+        }
+
+        Result& result = results[ frame - 1 ];
+        time = frameVisitor.finish( result ) + 1.f;
+        result.jitter = jitterVisitor.getJitter();
+
+        if( setup.verbose )
+            std::cout << filename << ", " << frame << ", " << result.makespan
+                      << ", " << result.imbalance << ", " << result.jitter
+                      << std::endl;
+    }
+
+    eq::server::Global::clear();
+    server->deleteConfigs(); // break server <-> config ref circle
+    return results;
+}
+
+Result _average( const Results& results, const size_t begin )
+{
+    Result average;
+    average.imbalance = 0.f;
+    for( size_t i = begin; i < results.size(); ++i )
+    {
+        const Result& result = results[i];
+        TESTINFO( result.makespan > 0.f, i );
+        TESTINFO( result.imbalance >= .99f, i << ": " << result.imbalance );
+
+        average.makespan += result.makespan;
+        average.imbalance += result.imbalance;
+        average.jitter += result.jitter;
+    }
+
+    const float nResults = float( results.size() - begin );
+    average.makespan /= nResults;
+    average.imbalance /= nResults;
+    average.jitter /= nResults;
+    return average;
+}
+
+// @return the results of all frames after printing the average of the second
+//         half against the first frame
+Results _report( const std::string& filename, const Setup& setup )
+{
+    const Results results = _simulate( filename, setup );
+    const Result average = _average( results, results.size() / 2 );
+
+    std::cout << filename << ": " << setup.nFrames << " frames, makespan "
+              << results.front().makespan << " -> " << average.makespan
+              << " ms, imbalance " << results.front().imbalance << " -> "
+              << average.imbalance << ", jitter " << average.jitter
+              << std::endl;
+    return results;
+}
+}
+
+int main( int argc, char **argv )
+{
+    TEST( lunchbox::init( argc, argv ));
+
+    Setup setup;
+    std::string config;
+    try
+    {
+        TCLAP::CmdLine command( "Offline load-balancing simulator", ' ',
+                                eq::Version::getString( ));
+        TCLAP::ValueArg< std::string > configArg( "c", "config",
+                                                  "configuration file", false,
+                                                  "", "string", command );
+        TCLAP::ValueArg< std::string > costArg( "m", "cost",
+                                   "cost model (uniform, hotspot, moving)",
+                                                false, "hotspot", "string",
+                                                command );
+        TCLAP::SwitchArg homogeneousArg( "g", "homogeneous",
+                                         "Use GPUs of equal speed", command,
+                                         false );
+        TCLAP::ValueArg< uint32_t > framesArg( "n", "numFrames",
+                                               "number of simulated frames",
+                                               false, 100, "unsigned",
+                                               command );
+        TCLAP::SwitchArg verboseArg( "v", "verbose",
+                     "print frame, makespan, imbalance and jitter per frame",
+                                     command, false );
+        command.parse( argc, argv );
+
+        config = configArg.getValue();
+        setup.heterogeneous = !homogeneousArg.isSet();
+        setup.nFrames = LB_MAX( framesArg.getValue(), 2u );
+        setup.verbose = verboseArg.isSet();
+
+        const std::string& cost = costArg.getValue();
+        if( cost == "uniform" )
+            setup.model = COST_UNIFORM;
+        else if( cost == "moving" )
+            setup.model = COST_MOVING;
+    }
+    catch( const TCLAP::ArgException& exception )
+    {
+        LBERROR << "Command line parse error: " << exception.error()
+                << " for argument " << exception.argId() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if( !config.empty( ))
+    {
+        _report( config, setup );
+        TEST( lunchbox::exit( ));
+        return EXIT_SUCCESS;
+    }
+
+    // Load-balanced configs have to compensate the slower GPUs and hot spot
+    const char* balanced[] = { "configs/2-window.2D.lb.eqc",
+                               "configs/2-window.DB.lb.eqc" };
+    for( size_t i = 0; i < sizeof( balanced ) / sizeof( char* ); ++i )
+    {
+        const Results results = _report( balanced[i], setup );
+        const Result average = _average( results, results.size() / 2 );
+        TESTINFO( average.imbalance < results.front().imbalance,
+                  balanced[i] << ": " << average.imbalance << " >= "
+                              << results.front().imbalance );
+        TESTINFO( average.imbalance < 1.25f,
+                  balanced[i] << ": " << average.imbalance );
+    }
+
+    // Other equalizers only need to run
+    const char* others[] = { "configs/4-window.DB.2D.lb.eqc",
+                             "configs/4-window.hybrid.lb.eqc",
+                             "configs/2-window.2D.DFR.eqc",
+                             "configs/4-window.DPlex.eqc",
+                             "configs/2-window.wall.lb.eqc" };
+    for( size_t i = 0; i < sizeof( others ) / sizeof( char* ); ++i )
+        _report( others[i], setup );
+
+    TEST( lunchbox::exit( ));
+    return EXIT_SUCCESS;
+}
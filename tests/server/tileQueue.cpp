@@ -0,0 +1,150 @@
+
+/* Copyright (c) 2013, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests the tile distribution of work-stealing tile queues and simulates
+// consumers of different speed draining them, including one which never pulls
+
+#include <test.h>
+#include <eq/server/tileQueue.h>
+
+#include <algorithm>
+#include <deque>
+
+using eq::server::TileQueue;
+
+namespace
+{
+typedef std::deque< size_t > Queue;
+typedef std::vector< Queue > Queues;
+
+// distribute the tiles like TileQueue::distributeTiles
+Queues _distribute( const size_t nTiles, const size_t nConsumers )
+{
+    Queues queues( 2 * nConsumers );
+    for( size_t i = 0; i < nConsumers; ++i )
+    {
+        size_t begin, middle, end;
+        TileQueue::getRange( nTiles, nConsumers, i, begin, middle, end );
+        TEST( begin <= middle && middle <= end );
+        TEST( i > 0 || begin == 0 );
+        TEST( i < nConsumers - 1 || end == nTiles );
+
+        for( size_t j = begin; j < middle; ++j )
+            queues[ 2 * i ].push_back( j );
+        for( size_t j = end; j > middle; --j )
+            queues[ 2 * i + 1 ].push_back( j - 1 );
+    }
+    return queues;
+}
+
+// Each consumer renders a tile in 'speed' steps, a speed of 0 never pulls.
+// Consumers drain their queues in order and skip a queue once it is empty,
+// as eq::Channel does.
+void _simulate( const size_t nTiles, const std::vector< size_t >& speeds )
+{
+    const size_t nConsumers = speeds.size();
+    Queues queues = _distribute( nTiles, nConsumers );
+
+    std::vector< size_t > consumed( nTiles, 0 );
+    std::vector< std::vector< size_t > > orders;
+    std::vector< size_t > positions( nConsumers, 0 );
+    std::vector< size_t > busy( nConsumers, 0 );
+    for( size_t i = 0; i < nConsumers; ++i )
+        orders.push_back( TileQueue::getDrainOrder( nConsumers, i ));
+
+    for( bool active = true; active; )
+    {
+        active = false;
+        for( size_t i = 0; i < nConsumers; ++i )
+        {
+            if( speeds[i] == 0 )
+                continue;
+            if( busy[i] > 0 )
+            {
+                --busy[i];
+                active = true;
+                continue;
+            }
+
+            const std::vector< size_t >& order = orders[i];
+            size_t& position = positions[i];
+            while( position < order.size() && queues[ order[ position ]].empty())
+                ++position;
+            if( position == order.size( ))
+                continue;
+
+            Queue& queue = queues[ order[ position ]];
+            ++consumed[ queue.front() ];
+            queue.pop_front();
+            busy[i] = speeds[i] - 1;
+            active = true;
+        }
+    }
+
+    for( size_t i = 0; i < nTiles; ++i )
+        TESTINFO( consumed[i] == 1, "tile " << i << " consumed " <<
+                  consumed[i] << " times by " << nConsumers << " consumers" );
+}
+}
+
+int main( int, char** )
+{
+    // every queue is drained exactly once, by consumers and others alike
+    for( size_t nConsumers = 1; nConsumers < 6; ++nConsumers )
+    {
+        for( size_t consumer = 0; consumer <= nConsumers; ++consumer )
+        {
+            const std::vector< size_t > order =
+                TileQueue::getDrainOrder( nConsumers, consumer );
+            TEST( order.size() == 2 * nConsumers );
+            std::vector< size_t > seen( 2 * nConsumers, 0 );
+            for( size_t i = 0; i < order.size(); ++i )
+                ++seen[ order[i] ];
+            TEST( std::count( seen.begin(), seen.end(), 1 ) ==
+                  ptrdiff_t( seen.size( )));
+            if( consumer < nConsumers )
+                TEST( order.front() == 2 * consumer );
+        }
+
+        // each tile is assigned to exactly one queue
+        for( size_t nTiles = 0; nTiles < 40; ++nTiles )
+        {
+            const Queues queues = _distribute( nTiles, nConsumers );
+            std::vector< size_t > assigned( nTiles, 0 );
+            for( size_t i = 0; i < queues.size(); ++i )
+                for( size_t j = 0; j < queues[i].size(); ++j )
+                    ++assigned[ queues[i][j] ];
+            TEST( std::count( assigned.begin(), assigned.end(), 1 ) ==
+                  ptrdiff_t( nTiles ));
+        }
+    }
+
+    std::vector< size_t > speeds;
+    speeds.push_back( 1 );
+    _simulate( 100, speeds );
+
+    speeds.push_back( 3 );
+    speeds.push_back( 0 ); // never pulls, e.g., a stopped channel
+    speeds.push_back( 7 );
+    _simulate( 100, speeds );
+    _simulate( 3, speeds );
+
+    speeds.assign( 4, 0 ); // only the last consumer pulls
+    speeds.back() = 2;
+    _simulate( 57, speeds );
+    return EXIT_SUCCESS;
+}
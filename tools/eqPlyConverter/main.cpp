@@ -28,6 +28,7 @@
 
 #include <eq/eq.h>
 #include <vertexBufferRoot.h>
+#include <vertexData.h>
 
 namespace
 {
@@ -44,13 +45,49 @@ static bool _isPlyfile( const std::string& filename )
     }
     return true;
 }
+
+/*  Time the kd-tree construction of the given PLY file, without writing the
+    binary representation.  */
+static void _benchmark( const std::string& filename )
+{
+    lunchbox::Clock clock;
+    mesh::VertexData data;
+    if( !data.readPlyFile( filename ))
+    {
+        LBWARN << "Can't load model: " << filename << std::endl;
+        return;
+    }
+    const float readTime = clock.resetTimef();
+
+    data.calculateNormals();
+    data.scale( 2.0f );
+    const float prepareTime = clock.resetTimef();
+
+    mesh::VertexBufferRoot model;
+    model.setupTree( data );
+    const float setupTime = clock.getTimef();
+
+    const size_t nTriangles = data.triangles.size();
+    std::cout << filename << ": " << nTriangles << " triangles, read "
+              << readTime << " ms, normals " << prepareTime << " ms, kd-tree "
+              << setupTime << " ms, "
+              << size_t( nTriangles / LB_MAX( setupTime, 1.f ) * 1000.f )
+              << " triangles/s"
+              << std::endl;
+}
 }
 
 int main( const int argc, char** argv )
 {
     eq::Strings filenames;
+    bool benchmark = false;
     for( int i=1; i < argc; ++i )
-        filenames.push_back( argv[i] );
+    {
+        if( std::string( argv[i] ) == "--benchmark" )
+            benchmark = true;
+        else
+            filenames.push_back( argv[i] );
+    }
 
     while( !filenames.empty( ))
     {
@@ -59,6 +96,12 @@ int main( const int argc, char** argv )
 
         if( _isPlyfile( filename ))
         {
+            if( benchmark )
+            {
+                _benchmark( filename );
+                continue;
+            }
+
             mesh::VertexBufferRoot* model = new mesh::VertexBufferRoot;
             if( !model->readFromFile( filename.c_str( )))
                 LBWARN << "Can't load model: " << filename << std::endl;